@@ -1,157 +1,846 @@
 #include <atomic>
-#include <bitset>
+#include <chrono>
 #include <thread>
 #include <cinttypes>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
 
-constexpr unsigned Num_threads = 16;
-constexpr unsigned Num_count = 4 * 1024 * 1024;
+#include "barrier.h"
+#include "cpu_topology.h"
+#include "multi_spin_lock.h"
+#include "perf_counters.h"
+
+// Can be changed by command line parameters.
+//
+unsigned num_threads = 16;
+std::uint64_t num_count = 4 * 1024 * 1024;
+
+// Placement of threads on CPUs for the current tests.
+//
+Cpu_topology::Placement placement = Cpu_topology::None;
+
+// CPU to pin each thread to (by thread index), empty if not pinned.
+//
+std::vector<unsigned> thread_cpu;
+
+// Hardware counters, for all the threads of each test.
+//
+Perf_counters::Counters counters;
 
 bool failed;
 
-template <typename Integral, Integral (*incr_func)(std::atomic<Integral> &)>
-class Test
+// One line of the summary table.
+//
+struct Result
+{
+  const char *placement;
+  const char *type_name;
+  const char *strategy;
+  const char *order;
+  double seconds;
+  double jain;
+  double cv;
+  std::uint64_t max_streak;
+  Perf_counters::Values pc;
+};
+
+std::vector<Result> results;
+
+// The values a thread got from incr_func, from first to first + length - 1.
+//
+struct Run
+{
+  std::uint64_t first;
+  std::uint64_t length;
+};
+
+// Each thread records the values it got (which should be increasing) as a
+// sequence of runs of consecutive values.  A run is encoded as a varint
+// (7 bits per byte, low bits first) of (gap << 1) | (length > 1), followed
+// by a varint of length - 1 if length is more than 1.  The gap is the
+// first value of the run minus the value after the end of the previous
+// run.  With threads interleaving, most runs have length 1 and a gap less
+// than 64, so take one byte.  The bytes are stored in fixed-size chunks,
+// allocated (mostly) before the timed loop, so logging a value never
+// copies the log.
+//
+class Run_log
 {
 public:
-  Test()
+  static constexpr std::size_t Chunk_size = 64 * 1024;
+
+  // Allocate chunks for at least the given number of bytes.
+  //
+  void reserve(std::uint64_t bytes)
   {
-    for (unsigned idx = 1; idx < Num_threads; ++idx)
-      th[idx] = std::thread(thread_func, &i, did + idx, &starting_pistol);
+    while ((chunks.size() * Chunk_size) < bytes)
+      chunks.emplace_back(new unsigned char[Chunk_size]);
+    if (chunks.empty())
+      chunks.emplace_back(new unsigned char[Chunk_size]);
+  }
+
+  void add(std::uint64_t v)
+  {
+    if (v == (cur.first + cur.length))
+      ++cur.length;
+    else if (v > (cur.first + cur.length))
+    {
+      flush();
+      cur = Run{v, 1};
+    }
+    else if (not bad)
+      bad = v;
+  }
+
+  // Encode the current run.  Must be called after the last add().
+  //
+  void flush()
+  {
+    if (cur.length == 0)
+      return;
+
+    put(((cur.first - prev_end) << 1) bitor (cur.length > 1));
+    if (cur.length > 1)
+      put(cur.length - 1);
+
+    prev_end = cur.first + cur.length;
+    num_values += cur.length;
+    ++num_runs;
+    if (cur.length > max_run_)
+      max_run_ = cur.length;
+    cur.length = 0;
+  }
+
+  // First value that was not more than the previous value, or zero.
+  //
+  std::uint64_t not_increasing() const { return(bad); }
+
+  std::uint64_t values() const { return(num_values); }
+  std::uint64_t runs() const { return(num_runs); }
+  std::uint64_t max_run() const { return(max_run_); }
+
+  std::uint64_t bytes() const
+  {
+    return(chunks.empty() ? 0 : ((chunk_idx * Chunk_size) + pos));
+  }
+
+  // Number of chunks allocated after reserve() (during the timed loop).
+  //
+  std::size_t extra_chunks() const { return(extra); }
 
-    starting_pistol = true;
+  // Decodes the runs in a log, in order.
+  //
+  class Reader
+  {
+  public:
+    explicit Reader(const Run_log &l) : log(l) { }
 
-    // Main thread is thread index 0.
+    // Returns false if there are no more runs.
     //
-    thread_func(&i, did, &starting_pistol);
+    bool next(Run &run)
+    {
+      if ((chunk_idx * Chunk_size + pos) >= log.bytes())
+        return(false);
+
+      std::uint64_t t = get();
+      run.first = end + (t >> 1);
+      run.length = (t bitand 1) ? get() + 1 : 1;
+      end = run.first + run.length;
+
+      return(true);
+    }
+
+  private:
+    std::uint64_t get()
+    {
+      std::uint64_t x = 0;
+      unsigned shift = 0;
+      unsigned char b;
+      do
+      {
+        if (pos == Chunk_size)
+        {
+          ++chunk_idx;
+          pos = 0;
+        }
+        b = log.chunks[chunk_idx][pos++];
+        x |= std::uint64_t(b bitand 0x7f) << shift;
+        shift += 7;
+      }
+      while (b bitand 0x80);
 
-    for (unsigned idx = 1; idx < Num_threads; ++idx)
-      th[idx].join();
+      return(x);
+    }
 
-    std::bitset<Num_count> anded, all;
+    const Run_log &log;
+    std::size_t chunk_idx = 0, pos = 0;
+    std::uint64_t end = 0;
+  };
 
-    for (unsigned idx = 0; idx < Num_threads; ++idx)
+private:
+  void put(std::uint64_t x)
+  {
+    while (x >= 0x80)
     {
-      anded = all bitand did[idx];
+      put_byte((x bitand 0x7f) bitor 0x80);
+      x >>= 7;
+    }
+    put_byte(x);
+  }
 
-      if (anded.any())
+  void put_byte(unsigned char b)
+  {
+    if (pos == Chunk_size)
+    {
+      if (++chunk_idx == chunks.size())
       {
-        failed = true;
-        for (unsigned bidx = 0; bidx < Num_count; ++bidx)
-          if (anded[bidx])
-          {
-            std::cout << "FAILED: double set: thread_index=" << idx
-                      << " count=" << (bidx + 1) << '\n';
-            return;
-          }
+        chunks.emplace_back(new unsigned char[Chunk_size]);
+        ++extra;
       }
-      all = all bitor did[idx];
+      pos = 0;
     }
-    if (not all.all())
+    chunks[chunk_idx][pos++] = b;
+  }
+
+  std::vector<std::unique_ptr<unsigned char[]> > chunks;
+  std::size_t chunk_idx = 0, pos = 0, extra = 0;
+
+  // Run not yet encoded.  Values start at 1, so the initial (empty) run
+  // does not match.
+  //
+  Run cur{0, 0};
+
+  std::uint64_t prev_end = 0, bad = 0;
+  std::uint64_t num_values = 0, num_runs = 0, max_run_ = 0;
+};
+
+// Check that each value from 1 to num_count appears in exactly one run, by
+// merging the run logs in order of first value.  Returns false and prints
+// a message on failure.
+//
+bool check_logs(const std::vector<Run_log> &log)
+{
+  using Head = std::pair<std::uint64_t, unsigned>; // (first, thread index)
+
+  std::priority_queue<Head, std::vector<Head>, std::greater<Head> > heads;
+  std::vector<Run_log::Reader> reader;
+  std::vector<Run> run(log.size());
+
+  reader.reserve(log.size());
+
+  for (unsigned idx = 0; idx < log.size(); ++idx)
+  {
+    if (log[idx].not_increasing())
+    {
+      std::cout << "FAILED: values not increasing: thread_index=" << idx
+                << " count=" << log[idx].not_increasing() << '\n';
+      return(false);
+    }
+
+    reader.emplace_back(log[idx]);
+    if (reader[idx].next(run[idx]))
+      heads.push(Head(run[idx].first, idx));
+  }
+
+  std::uint64_t expected = 1;
+
+  while (not heads.empty())
+  {
+    unsigned idx = heads.top().second;
+    heads.pop();
+
+    if (run[idx].first < expected)
+    {
+      std::cout << "FAILED: double set: thread_index=" << idx
+                << " count=" << run[idx].first << '\n';
+      return(false);
+    }
+    if (run[idx].first > expected)
+    {
+      std::cout << "FAILED: not set: count: " << expected << '\n';
+      return(false);
+    }
+    expected += run[idx].length;
+
+    if (reader[idx].next(run[idx]))
+      heads.push(Head(run[idx].first, idx));
+  }
+  if (expected != (num_count + 1))
+  {
+    std::cout << "FAILED: not set: count: " << expected << '\n';
+    return(false);
+  }
+  return(true);
+}
+
+// Each thread records a timestamp after every Sample_interval values it
+// gets.  Must be a power of 2.
+//
+const std::uint64_t Sample_interval = 1024;
+
+// Jain's fairness index, (sum x)^2 / (n * sum x^2).  1 if all x are equal,
+// 1/n if one x has all the total.
+//
+double jain_index(const std::vector<double> &x)
+{
+  double sum = 0, sum_sq = 0;
+  for (double v : x)
+  {
+    sum += v;
+    sum_sq += v * v;
+  }
+  return(sum_sq == 0 ? 1 : (sum * sum) / (x.size() * sum_sq));
+}
+
+// Coefficient of variation (standard deviation / mean).
+//
+double coeff_of_var(const std::vector<double> &x)
+{
+  double mean = 0;
+  for (double v : x)
+    mean += v;
+  mean /= x.size();
+
+  double var = 0;
+  for (double v : x)
+    var += (v - mean) * (v - mean);
+  var /= x.size();
+
+  return(mean == 0 ? 0 : std::sqrt(var) / mean);
+}
+
+// Counter is the type of the counter all the threads increment.  incr_func
+// increments it, and returns the resulting value.
+//
+template <typename Counter, typename Integral, Integral (*incr_func)(Counter &)>
+class Test
+{
+public:
+  Test()
+    : th(num_threads), log(num_threads), skew(num_threads),
+      stamps(num_threads), finish(num_threads)
+  {
+    {
+      // Counting must start before the threads are created, for their
+      // counts to be included.
+      //
+      Perf_counters::Scope ps(counters, &pc);
+
+      for (unsigned idx = 1; idx < num_threads; ++idx)
+        th[idx] = std::thread(thread_func, this, idx);
+
+      // Main thread is thread index 0.
+      //
+      thread_func(this, 0);
+
+      for (unsigned idx = 1; idx < num_threads; ++idx)
+        th[idx].join();
+    }
+
+    elapsed =
+      std::chrono::steady_clock::now() - starting_pistol.release_time();
+
+    if (not thread_cpu.empty())
+      Cpu_topology::unpin();
+
+    if (not check_logs(log))
     {
       failed = true;
-      for (unsigned bidx = 0; bidx < Num_count; ++bidx)
-        if (not all[bidx])
-        {
-          std::cout << "FAILED: not set: count: " << (bidx + 1) << '\n';
-          return;
-        }
+      return;
     }
-    for (unsigned idx = 0; idx < Num_threads; ++idx)
-      std::cout << "count[" << idx << "]=" << did[idx].count() << '\n';
+    report_threads();
+
+    Start_gate::Clock::duration max_skew{0};
+    for (unsigned idx = 0; idx < num_threads; ++idx)
+      if (skew[idx] > max_skew)
+        max_skew = skew[idx];
+    std::cout << "max start skew = "
+              << std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   max_skew).count()
+              << " ns\n";
+  }
+
+  double seconds() const
+  {
+    return(std::chrono::duration<double>(elapsed).count());
   }
 
+  // Fairness statistics.  See report_threads().
+  //
+  double jain() const { return(jain_); }
+  double cv() const { return(cv_); }
+  std::uint64_t max_streak() const { return(max_streak_); }
+
+  // Hardware counts, including thread creation.
+  //
+  const Perf_counters::Values & counts() const { return(pc); }
+
 private:
-  static void thread_func(
-    std::atomic<Integral> *i, std::bitset<Num_count> *did,
-    std::atomic<bool> *starting_pistol)
+  static void thread_func(Test *t, unsigned idx)
   {
     Integral ii;
+    Run_log &log = t->log[idx];
+
+    // About one byte for each value of an even share.
+    //
+    log.reserve(num_count / num_threads);
 
-    while (not *starting_pistol)
-      ;
+    if (not thread_cpu.empty() and not Cpu_topology::pin(thread_cpu[idx]))
+      std::cout << "pinning thread " << idx << " to cpu " << thread_cpu[idx]
+                << " failed\n";
+
+    t->starting_pistol.arrive_and_wait();
+    t->skew[idx] =
+      Start_gate::Clock::now() - t->starting_pistol.release_time();
+
+    std::vector<Start_gate::Clock::time_point> &stamps = t->stamps[idx];
+    stamps.reserve(num_count / Sample_interval / num_threads + 16);
+    std::uint64_t n = 0;
 
     do
     {
-      ii = incr_func(*i);
-      if (ii <= Num_count)
+      ii = incr_func(t->i);
+      if (ii <= num_count)
       {
-        (*did)[ii - 1] = true;
+        log.add(ii);
+
+        if (((++n) bitand (Sample_interval - 1)) == 0)
+          stamps.push_back(Start_gate::Clock::now());
       }
     }
-    while (ii < Num_count);
+    while (ii < num_count);
+
+    t->finish[idx] = Start_gate::Clock::now();
+
+    log.flush();
   }
 
-  std::atomic<Integral> i{0};
-  std::thread th[Num_threads];
-  std::bitset<Num_count> did[Num_threads];
-  std::atomic<bool> starting_pistol{false};
+  // Print count, number of runs, and throughput for each thread, and the
+  // size of the run logs, and compute the fairness statistics.  Jain's
+  // index and the coefficient of variation are for the counts of each
+  // thread during the time all the threads were incrementing (until the
+  // first thread finished), estimated from the timestamp samples.  The
+  // streak is the longest run of consecutive values gotten by the same
+  // thread.
+  //
+  void report_threads()
+  {
+    Start_gate::Clock::time_point start = starting_pistol.release_time();
+    Start_gate::Clock::time_point window_end = finish[0];
+    for (unsigned idx = 1; idx < num_threads; ++idx)
+      if (finish[idx] < window_end)
+        window_end = finish[idx];
+
+    std::vector<double> window_cnt(num_threads), total_cnt(num_threads);
+    double window_sum = 0;
+
+    max_streak_ = 0;
+
+    std::uint64_t log_bytes = 0;
+    std::size_t extra_chunks = 0;
+
+    for (unsigned idx = 0; idx < num_threads; ++idx)
+    {
+      std::uint64_t cnt = log[idx].values();
+      if (log[idx].max_run() > max_streak_)
+        max_streak_ = log[idx].max_run();
+      total_cnt[idx] = double(cnt);
+
+      log_bytes += log[idx].bytes();
+      extra_chunks += log[idx].extra_chunks();
+
+      std::size_t k = 0;
+      while ((k < stamps[idx].size()) and (stamps[idx][k] <= window_end))
+        ++k;
+      window_cnt[idx] = double(k * Sample_interval);
+      window_sum += window_cnt[idx];
+
+      double secs = std::chrono::duration<double>(finish[idx] - start).count();
+
+      std::cout << "count[" << idx << "]=" << cnt
+                << " runs=" << log[idx].runs()
+                << " Mincr/s=" << (secs > 0 ? cnt / secs / 1e6 : 0) << '\n';
+    }
+
+    // Too few samples, fall back to total counts.
+    //
+    const std::vector<double> &x = window_sum > 0 ? window_cnt : total_cnt;
+
+    jain_ = jain_index(x);
+    cv_ = coeff_of_var(x);
+
+    std::cout << "fairness (" << (window_sum > 0 ? "sampled" : "total")
+              << " counts): jain=" << jain_ << " cv=" << cv_
+              << " longest streak=" << max_streak_ << '\n';
+
+    std::cout << "run logs: " << log_bytes << " bytes ("
+              << (double(log_bytes) / num_count) << " per value), "
+              << extra_chunks << " chunks allocated while counting\n";
+  }
+
+  Counter i{};
+  std::vector<std::thread> th;
+
+  std::vector<Run_log> log;
+
+  using Start_gate = Simple_atomic::Barrier<>;
+
+  // Released when all threads are ready to start incrementing.
+  //
+  Start_gate starting_pistol{num_threads};
+
+  // Time from release of starting pistol until each thread started.
+  //
+  std::vector<Start_gate::Clock::duration> skew;
+
+  // Timestamp samples taken by each thread.
+  //
+  std::vector<std::vector<Start_gate::Clock::time_point> > stamps;
+
+  // Time when each thread finished incrementing.
+  //
+  std::vector<Start_gate::Clock::time_point> finish;
+
+  double jain_ = 1, cv_ = 0;
+  std::uint64_t max_streak_ = 0;
+
+  std::chrono::steady_clock::duration elapsed;
+
+  Perf_counters::Values pc;
 };
 
-template <typename Integral>
+template <typename Counter, typename Integral, Integral (*incr_func)(Counter &)>
+void run(const char *type_name, const char *strategy, const char *order)
+{
+  std::cout << '\n' << type_name << ' ' << strategy << ' ' << order << '\n';
+
+  Test<Counter, Integral, incr_func> t;
+
+  results.push_back(
+    {Cpu_topology::name(placement), type_name, strategy, order, t.seconds(),
+     t.jain(), t.cv(), t.max_streak(), t.counts()});
+}
+
+const char * order_name(std::memory_order order)
+{
+  switch (order)
+  {
+  case std::memory_order_relaxed:
+    return("relaxed");
+  case std::memory_order_acq_rel:
+    return("acq_rel");
+  case std::memory_order_seq_cst:
+    return("seq_cst");
+  default:
+    return("?");
+  }
+}
+
+// Orders to use for plain loads and stores in a function whose
+// read-modify-write operations use the given order.
+//
+constexpr std::memory_order load_order(std::memory_order order)
+{
+  return(order == std::memory_order_acq_rel ? std::memory_order_acquire
+                                            : order);
+}
+
+constexpr std::memory_order store_order(std::memory_order order)
+{
+  return(order == std::memory_order_acq_rel ? std::memory_order_release
+                                            : order);
+}
+
+template <typename Integral, std::memory_order Order>
 Integral incr_ce_weak(std::atomic<Integral> &i)
 {
-  Integral curr = i;
+  Integral curr = i.load(load_order(Order));
 
-  while (not i.compare_exchange_weak(curr, curr + 1))
+  while (not i.compare_exchange_weak(curr, curr + 1, Order))
     ;
 
   return(curr + 1);
 }
 
-template <typename Integral>
+template <typename Integral, std::memory_order Order>
 Integral incr_ce_strong(std::atomic<Integral> &i)
 {
-  Integral curr = i;
+  Integral curr = i.load(load_order(Order));
 
-  while (not i.compare_exchange_strong(curr, curr + 1))
+  while (not i.compare_exchange_strong(curr, curr + 1, Order))
     ;
 
   return(curr + 1);
 }
 
+// Operators always use seq_cst.
+//
 template <typename Integral>
 Integral incr_op(std::atomic<Integral> &i)
 {
   return ++i;
 }
 
-template <typename Integral>
+template <typename Integral, std::memory_order Order>
 Integral incr_fa(std::atomic<Integral> &i)
 {
-  return i.fetch_add(1) + 1;
+  return i.fetch_add(1, Order) + 1;
+}
+
+// Lock the counter by exchanging it with a value it never reaches, then
+// store the incremented value.
+//
+template <typename Integral, std::memory_order Order>
+Integral incr_xchg(std::atomic<Integral> &i)
+{
+  constexpr Integral Busy = ~Integral(0);
+  Integral curr;
+
+  while ((curr = i.exchange(Busy, load_order(Order))) == Busy)
+    ;
+
+  i.store(curr + 1, store_order(Order));
+
+  return(curr + 1);
+}
+
+// Lock the counter by setting its top bit with fetch_or, then store the
+// incremented value (which clears the top bit).
+//
+template <typename Integral, std::memory_order Order>
+Integral incr_fo(std::atomic<Integral> &i)
+{
+  constexpr Integral Lock_bit = Integral(1) << (sizeof(Integral) * 8 - 1);
+  Integral curr;
+
+  while ((curr = i.fetch_or(Lock_bit, load_order(Order))) bitand Lock_bit)
+    ;
+
+  i.store(curr + 1, store_order(Order));
+
+  return(curr + 1);
+}
+
+// Double-width counter.  The tag changes on every increment, so the
+// compare-exchange really depends on all 128 bits.
+//
+struct alignas(16) Wide
+{
+  std::uint64_t count;
+  std::uint64_t tag;
+};
+
+template <std::memory_order Order>
+std::uint64_t incr_cas128(std::atomic<Wide> &i)
+{
+  Wide curr = i.load(load_order(Order));
+
+  while (not i.compare_exchange_weak(
+               curr, Wide{curr.count + 1, curr.tag + 0x9e3779b97f4a7c15},
+               Order))
+    ;
+
+  return(curr.count + 1);
+}
+
+template <typename Integral>
+struct Spin_locked
+{
+  Multi_spin_lock<> sl;
+  Integral v;
+};
+
+template <typename Integral>
+Integral incr_spin(Spin_locked<Integral> &c)
+{
+  Multi_spin_lock<>::Sentry sentry(c.sl);
+
+  return(++c.v);
 }
 
 template <typename Integral>
-void test_for_type()
+struct Mutex_locked
 {
-  std::cout << "\nincr_ce_weak\n";
-  Test<Integral, incr_ce_weak<Integral> >();
+  std::mutex m;
+  Integral v;
+};
 
-  std::cout << "\nincr_ce_strong\n";
-  Test<Integral, incr_ce_strong<Integral> >();
+template <typename Integral>
+Integral incr_mutex(Mutex_locked<Integral> &c)
+{
+  std::lock_guard<std::mutex> lg(c.m);
 
-  std::cout << "\nincr_op\n";
-  Test<Integral, incr_op<Integral> >();
+  return(++c.v);
+}
+
+template <typename Integral, std::memory_order Order>
+void test_for_order(const char *type_name)
+{
+  using A = std::atomic<Integral>;
+  const char *o = order_name(Order);
+
+  run<A, Integral, incr_ce_weak<Integral, Order> >(
+    type_name, "incr_ce_weak", o);
+
+  run<A, Integral, incr_ce_strong<Integral, Order> >(
+    type_name, "incr_ce_strong", o);
+
+  if (Order == std::memory_order_seq_cst)
+    run<A, Integral, incr_op<Integral> >(type_name, "incr_op", o);
+
+  run<A, Integral, incr_fa<Integral, Order> >(type_name, "incr_fa", o);
+
+  run<A, Integral, incr_xchg<Integral, Order> >(type_name, "incr_xchg", o);
+
+  run<A, Integral, incr_fo<Integral, Order> >(type_name, "incr_fo", o);
+}
+
+template <typename Integral>
+void test_for_type(const char *type_name)
+{
+  // incr_fo uses the top bit as a lock.  Each thread may increment once
+  // after another thread reaches the count, so the final count can be up
+  // to num_count + num_threads - 1.
+  //
+  if ((num_count + num_threads - 1) >=
+      (std::uint64_t(1) << (sizeof(Integral) * 8 - 1)))
+  {
+    std::cout << "\nskipping " << type_name << ", count too large\n";
+    return;
+  }
 
-  std::cout << "\nincr_fa\n";
-  Test<Integral, incr_fa<Integral> >();
+  test_for_order<Integral, std::memory_order_relaxed>(type_name);
+  test_for_order<Integral, std::memory_order_acq_rel>(type_name);
+  test_for_order<Integral, std::memory_order_seq_cst>(type_name);
 }
 
-int main()
+void print_results()
+{
+  std::cout << "\n"
+            << std::left << std::setw(8) << "place"
+            << std::setw(10) << "type"
+            << std::setw(16) << "strategy"
+            << std::setw(9) << "order"
+            << std::right << std::setw(10) << "ms"
+            << std::setw(10) << "ns/incr"
+            << std::setw(7) << "jain"
+            << std::setw(7) << "cv"
+            << std::setw(10) << "streak";
+  Perf_counters::print_heading(std::cout, 9);
+  std::cout << "  (counts per incr)\n";
+
+  for (const Result &r : results)
+  {
+    std::cout << std::left << std::setw(8) << r.placement
+              << std::setw(10) << r.type_name
+              << std::setw(16) << r.strategy
+              << std::setw(9) << r.order
+              << std::right << std::fixed
+              << std::setw(10) << std::setprecision(1) << (r.seconds * 1e3)
+              << std::setw(10) << std::setprecision(2)
+              << (r.seconds * 1e9 / num_count)
+              << std::setw(7) << r.jain
+              << std::setw(7) << r.cv
+              << std::setw(10) << r.max_streak;
+    Perf_counters::print(std::cout, r.pc.per(double(num_count)), 9);
+    std::cout << '\n';
+  }
+}
+
+void test_all()
 {
   #if 0
-  std::cout << "\nuint16\n";
-  test_for_type<std::uint16_t>();
+  test_for_type<std::uint16_t>("uint16");
   #endif
 
-  std::cout << "\nuint32\n";
-  test_for_type<std::uint32_t>();
+  test_for_type<std::uint32_t>("uint32");
+
+  test_for_type<std::uint64_t>("uint64");
+
+  test_for_type<std::uintptr_t>("uintptr");
+
+  std::cout << "\nstd::atomic<Wide> is_lock_free() = "
+            << std::atomic<Wide>().is_lock_free() << '\n';
+
+  run<std::atomic<Wide>, std::uint64_t,
+      incr_cas128<std::memory_order_relaxed> >(
+    "uint128", "incr_cas128", "relaxed");
+
+  run<std::atomic<Wide>, std::uint64_t,
+      incr_cas128<std::memory_order_acq_rel> >(
+    "uint128", "incr_cas128", "acq_rel");
+
+  run<std::atomic<Wide>, std::uint64_t,
+      incr_cas128<std::memory_order_seq_cst> >(
+    "uint128", "incr_cas128", "seq_cst");
+
+  run<Spin_locked<std::uint64_t>, std::uint64_t, incr_spin<std::uint64_t> >(
+    "uint64", "incr_spin", "lock");
+
+  run<Mutex_locked<std::uint64_t>, std::uint64_t, incr_mutex<std::uint64_t> >(
+    "uint64", "incr_mutex", "lock");
+}
+
+int main(int n_arg, const char * const *arg)
+{
+  // Sweep all placements by default.
+  //
+  bool all = true;
+
+  long n_threads = long(num_threads);
+
+  if ((n_arg > 4) or
+      ((n_arg > 1) and ((n_threads = std::strtol(arg[1], nullptr, 0)) < 1)) or
+      ((n_arg > 2) and ((num_count = std::strtoull(arg[2], nullptr, 0)) < 1)) or
+      ((n_arg > 3) and not (all = (std::string(arg[3]) == "all")) and
+       not Cpu_topology::parse(arg[3], placement)))
+  {
+    std::cerr << "optional first parameter: number of threads (default 16)\n";
+    std::cerr << "optional second parameter: count target (default 4M)\n";
+    std::cerr << "optional third parameter: thread placement, one of none, "
+                 "smt, ccx, socket, all (default all)\n";
+
+    std::exit(1);
+  }
+
+  num_threads = unsigned(n_threads);
 
-  std::cout << "\nuint64\n";
-  test_for_type<std::uint64_t>();
+  std::cout << "threads=" << num_threads << " count=" << num_count << '\n';
+
+  // Must read the topology before the main thread is pinned.
+  //
+  const std::vector<Cpu_topology::Cpu> topo = Cpu_topology::read();
+
+  for (Cpu_topology::Placement p : Cpu_topology::All_placements)
+  {
+    if (all)
+      placement = p;
+    else if (p != placement)
+      continue;
+
+    thread_cpu = Cpu_topology::cpus_for(placement, num_threads, topo);
+
+    std::cout << "\nplacement=" << Cpu_topology::name(placement)
+              << " cpus=";
+    if (thread_cpu.empty())
+      std::cout << "any";
+    for (unsigned idx = 0; idx < thread_cpu.size(); ++idx)
+      std::cout << (idx ? "," : "") << thread_cpu[idx];
+    std::cout << '\n';
+
+    test_all();
+  }
 
-  std::cout << "\nuintptr\n";
-  test_for_type<std::uintptr_t>();
+  print_results();
 
   if (not failed)
     std::cout << "\nSUCCESS\n";
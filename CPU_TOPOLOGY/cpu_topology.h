@@ -0,0 +1,369 @@
+/*
+Copyright (c) 2026 Walter William Karas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*
+CPU topology (Linux only), and pinning of threads to CPUs according to a
+placement policy, for benchmarks of contended memory.
+
+The topology is read from /sys/devices/system/cpu.  Only the CPUs in the
+affinity mask of the calling thread are used.  The placements are:
+
+none -- threads are not pinned.
+smt -- threads are packed onto SMT siblings (hyperthreads) of the same core,
+  then onto the next core sharing the same last-level cache, and so on.
+ccx -- one thread per core, all cores sharing the same last-level cache (core
+  complex), as far as possible.
+socket -- threads alternate between packages (sockets), one per core.
+
+If there are more threads than CPUs, CPUs are reused, starting over at the
+first CPU of the placement order.
+*/
+
+#ifndef CPU_TOPOLOGY_20261018
+#define CPU_TOPOLOGY_20261018
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace Cpu_topology
+{
+
+struct Cpu
+  {
+    unsigned id;
+
+    unsigned core;
+
+    unsigned package;
+
+    // Lowest CPU id of the CPUs sharing this CPU's last-level cache.
+    //
+    unsigned llc;
+
+    // Index of this CPU among the SMT siblings of its core (0 for the
+    // first sibling).
+    //
+    unsigned sibling;
+  };
+
+enum Placement { None, Smt, Ccx, Socket };
+
+const Placement All_placements[] = { None, Smt, Ccx, Socket };
+
+inline const char * name(Placement p)
+  {
+    switch (p)
+      {
+      case None:
+        return("none");
+      case Smt:
+        return("smt");
+      case Ccx:
+        return("ccx");
+      case Socket:
+        return("socket");
+      }
+
+    return("?");
+  }
+
+// Returns false if "s" is not the name of a placement.
+//
+inline bool parse(const char *s, Placement &p)
+  {
+    for (Placement q : All_placements)
+      if (std::strcmp(s, name(q)) == 0)
+        {
+          p = q;
+
+          return(true);
+        }
+
+    return(false);
+  }
+
+namespace Impl
+{
+
+// Parse a CPU list like "0-3,8,10-11".
+//
+inline std::vector<unsigned> parse_list(const std::string &s)
+  {
+    std::vector<unsigned> result;
+
+    const char *p = s.c_str();
+
+    while (*p)
+      {
+        char *end;
+
+        unsigned long first = std::strtoul(p, &end, 10), last = first;
+
+        if (end == p)
+          break;
+
+        p = end;
+
+        if (*p == '-')
+          {
+            last = std::strtoul(p + 1, &end, 10);
+
+            p = end;
+          }
+
+        for (unsigned long c = first; c <= last; ++c)
+          result.push_back(unsigned(c));
+
+        if (*p == ',')
+          ++p;
+      }
+
+    return(result);
+  }
+
+// Returns true if the first line of the file could be read.
+//
+inline bool read_line(const std::string &path, std::string &line)
+  {
+    std::ifstream f(path);
+
+    return(f and std::getline(f, line));
+  }
+
+inline unsigned read_unsigned(const std::string &path, unsigned dflt)
+  {
+    std::string line;
+
+    if (!read_line(path, line) or line.empty())
+      return(dflt);
+
+    return(unsigned(std::strtoul(line.c_str(), nullptr, 10)));
+  }
+
+// Lowest CPU sharing the highest level cache of the given CPU.
+//
+inline unsigned read_llc(const std::string &dir, unsigned dflt)
+  {
+    unsigned best_level = 0, llc = dflt;
+
+    for (unsigned idx = 0; ; ++idx)
+      {
+        std::string cdir = dir + "cache/index" + std::to_string(idx) + "/";
+
+        std::string line;
+
+        if (!read_line(cdir + "level", line))
+          break;
+
+        unsigned level = unsigned(std::strtoul(line.c_str(), nullptr, 10));
+
+        if ((level > best_level) and read_line(cdir + "shared_cpu_list", line))
+          {
+            std::vector<unsigned> l = parse_list(line);
+
+            if (!l.empty())
+              {
+                best_level = level;
+
+                llc = *std::min_element(l.begin(), l.end());
+              }
+          }
+      }
+
+    return(llc);
+  }
+
+} // end namespace Impl
+
+// Returns the CPUs the calling thread may run on, ordered by id.  (So,
+// call this before pinning the calling thread.)
+//
+inline std::vector<Cpu> read()
+  {
+    std::vector<Cpu> result;
+
+    cpu_set_t mask;
+
+    CPU_ZERO(&mask);
+
+    bool have_mask = sched_getaffinity(0, sizeof(mask), &mask) == 0;
+
+    std::string line;
+
+    if (!Impl::read_line("/sys/devices/system/cpu/online", line))
+      return(result);
+
+    for (unsigned id : Impl::parse_list(line))
+      {
+        if (have_mask and (id < CPU_SETSIZE) and !CPU_ISSET(id, &mask))
+          continue;
+
+        std::string dir =
+          "/sys/devices/system/cpu/cpu" + std::to_string(id) + "/";
+
+        Cpu c;
+
+        c.id = id;
+        c.core = Impl::read_unsigned(dir + "topology/core_id", id);
+        c.package =
+          Impl::read_unsigned(dir + "topology/physical_package_id", 0);
+        c.llc = Impl::read_llc(dir, c.package);
+        c.sibling = 0;
+
+        result.push_back(c);
+      }
+
+    // Core ids are only unique within a package.
+    //
+    for (Cpu &c : result)
+      for (const Cpu &o : result)
+        if ((o.id < c.id) and (o.package == c.package) and (o.core == c.core))
+          ++c.sibling;
+
+    return(result);
+  }
+
+// Returns the CPU ids to pin threads 0 through num_threads - 1 to, for the
+// given placement.  Returns an empty vector for None, or if the topology
+// could not be read.
+//
+inline std::vector<unsigned> cpus_for(
+  Placement p, unsigned num_threads, const std::vector<Cpu> &topo)
+  {
+    std::vector<unsigned> result;
+
+    if ((p == None) or topo.empty())
+      return(result);
+
+    // Rank of each CPU's core within its package, used to interleave
+    // packages for the Socket placement.
+    //
+    std::vector<unsigned> core_rank(topo.size(), 0);
+
+    for (unsigned i = 0; i < topo.size(); ++i)
+      for (const Cpu &o : topo)
+        if ((o.package == topo[i].package) and (o.sibling == 0) and
+            (o.core < topo[i].core))
+          ++core_rank[i];
+
+    std::vector<unsigned> order(topo.size());
+
+    for (unsigned i = 0; i < order.size(); ++i)
+      order[i] = i;
+
+    auto key = [&](unsigned i) -> std::vector<unsigned>
+      {
+        const Cpu &c = topo[i];
+
+        switch (p)
+          {
+          case Smt:
+            return(std::vector<unsigned>{c.package, c.llc, c.core, c.sibling});
+          case Ccx:
+            return(std::vector<unsigned>{c.package, c.llc, c.sibling, c.core});
+          default:
+            return(std::vector<unsigned>{c.sibling, core_rank[i], c.package});
+          }
+      };
+
+    std::stable_sort(
+      order.begin(), order.end(),
+      [&](unsigned a, unsigned b) { return(key(a) < key(b)); });
+
+    for (unsigned t = 0; t < num_threads; ++t)
+      result.push_back(topo[order[t % order.size()]].id);
+
+    return(result);
+  }
+
+namespace Impl
+{
+
+// Affinity mask of the calling thread before it was first pinned.
+//
+struct Saved_mask
+  {
+    bool saved;
+
+    cpu_set_t mask;
+  };
+
+inline Saved_mask & saved_mask()
+  {
+    static thread_local Saved_mask m;
+
+    return(m);
+  }
+
+} // end namespace Impl
+
+// Pin the calling thread to one CPU.  Returns false on failure.  If the
+// thread is not already pinned, its affinity mask is saved first, so
+// unpin() can restore it.
+//
+inline bool pin(unsigned cpu)
+  {
+    Impl::Saved_mask &saved = Impl::saved_mask();
+
+    if (!saved.saved)
+      {
+        if (pthread_getaffinity_np(
+              pthread_self(), sizeof(saved.mask), &saved.mask) != 0)
+          return(false);
+
+        saved.saved = true;
+      }
+
+    cpu_set_t mask;
+
+    CPU_ZERO(&mask);
+
+    CPU_SET(cpu, &mask);
+
+    return(pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask) == 0);
+  }
+
+// Undo pin(), restoring the affinity mask the calling thread had before it
+// was pinned (for example, one set with taskset).  Does nothing if the
+// thread is not pinned.  Returns false on failure.
+//
+inline bool unpin()
+  {
+    Impl::Saved_mask &saved = Impl::saved_mask();
+
+    if (!saved.saved)
+      return(true);
+
+    saved.saved = false;
+
+    return(
+      pthread_setaffinity_np(
+        pthread_self(), sizeof(saved.mask), &saved.mask) == 0);
+  }
+
+} // end namespace Cpu_topology
+
+#endif // Include once.
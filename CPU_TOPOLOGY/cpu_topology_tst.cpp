@@ -0,0 +1,140 @@
+/*
+Copyright (c) 2026 Walter William Karas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Unit testing for cpu_topology.h.
+
+#include "cpu_topology.h"
+#include "cpu_topology.h" // test re-inclusion guard
+
+#include <iostream>
+
+using namespace Cpu_topology;
+
+bool failed;
+
+void check(
+  Placement p, unsigned num_threads, const std::vector<Cpu> &topo,
+  const std::vector<unsigned> &expected)
+  {
+    if (cpus_for(p, num_threads, topo) != expected)
+      {
+        std::cout << "FAILED: placement " << name(p) << ", " << num_threads
+                  << " threads\n";
+
+        failed = true;
+      }
+  }
+
+int main()
+  {
+    // Two packages, each with two cores with two SMT siblings, and one
+    // last-level cache per package.  The ids are numbered the way Linux
+    // usually does it, with the second siblings last.
+    //
+    std::vector<Cpu> topo;
+
+    for (unsigned id = 0; id < 8; ++id)
+      {
+        Cpu c;
+
+        c.id = id;
+        c.core = id % 2;
+        c.package = (id / 2) % 2;
+        c.llc = c.package * 2;
+        c.sibling = id / 4;
+
+        topo.push_back(c);
+      }
+
+    check(None, 4, topo, {});
+    check(Smt, 4, topo, {0, 4, 1, 5});
+    check(Ccx, 4, topo, {0, 1, 4, 5});
+    check(Socket, 4, topo, {0, 2, 1, 3});
+    check(Smt, 10, topo, {0, 4, 1, 5, 2, 6, 3, 7, 0, 4});
+
+    {
+      const std::vector<unsigned> l =
+        Impl::parse_list("0-2,5,7-8\n");
+
+      if (l != std::vector<unsigned>({0, 1, 2, 5, 7, 8}))
+        {
+          std::cout << "FAILED: parse_list\n";
+
+          failed = true;
+        }
+    }
+
+    for (Placement p : All_placements)
+      {
+        Placement q;
+
+        if (!parse(name(p), q) or (q != p))
+          {
+            std::cout << "FAILED: parse " << name(p) << '\n';
+
+            failed = true;
+          }
+      }
+
+    // Print the topology of this machine.
+    //
+    topo = read();
+
+    for (const Cpu &c : topo)
+      std::cout << "cpu " << c.id << ": package=" << c.package << " core="
+                << c.core << " sibling=" << c.sibling << " llc=" << c.llc
+                << '\n';
+
+    if (topo.empty())
+      {
+        std::cout << "FAILED: read\n";
+
+        failed = true;
+      }
+    else
+      {
+        cpu_set_t before, after;
+
+        pthread_getaffinity_np(pthread_self(), sizeof(before), &before);
+
+        if (!pin(topo.back().id) or (sched_getcpu() != int(topo.back().id)))
+          {
+            std::cout << "FAILED: pin\n";
+
+            failed = true;
+          }
+
+        // The original mask should be restored.
+        //
+        if (!unpin() or
+            (pthread_getaffinity_np(pthread_self(), sizeof(after), &after) !=
+             0) or
+            !CPU_EQUAL(&before, &after))
+          {
+            std::cout << "FAILED: unpin\n";
+
+            failed = true;
+          }
+      }
+
+    if (!failed)
+      std::cout << "SUCCESS\n";
+
+    return(0);
+  }
@@ -0,0 +1,472 @@
+/*
+Copyright (c) 2026 Walter William Karas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Benchmark of the cost of dispatch.  Calls are made through an array of
+// Num_objs objects, of 1, 2, 4 or 16 different classes (chosen at random
+// for each element, so the sequence of call targets is not predictable
+// when there is more than one class).  The same calls are made with:
+//
+// - IFACE_CALL (Z_X interface, like in example.cpp)
+// - IFACE_FAT_CALL
+// - IFACE_CALL_ALL (to an Iface_group, so calls are ordered by class)
+// - IFACE_SEALED_CALL
+// - virtual functions (Z_X_v base class, like in old_way.cpp)
+// - std::function
+// - templates (direct calls, looping over an array for each class)
+//
+// The cost of conversion (followed by a call) is measured for static
+// iface_convert(), iface_convert() with the hash table, IFACE_CONVERT_CACHED,
+// iface_query_vptr(), and dynamic_cast (a cross cast to another base class).
+//
+// The time (in nanoseconds) and the number of branch mispredictions and
+// instructions (from PERF_COUNTERS) are printed per call.
+
+#include "iface.h"
+
+#include "perf_counters.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+// Add a constant to the parameter.
+//
+#define Z1_PARAMS(P) \
+P(unsigned, x)
+
+// Add the same constant to *acc.
+//
+#define Z2_PARAMS(P) \
+P(unsigned *, acc)
+
+#define Z_FUNC_LIST(F, FNR) \
+F(unsigned, z1, , Z1_PARAMS) \
+FNR(z2, , Z2_PARAMS)
+
+#define X1_PARAMS(P) \
+P(unsigned, x)
+
+#define Z_X_FUNC_LIST(F, FNR) \
+Z_FUNC_LIST(F, FNR) \
+F(unsigned, x1, , X1_PARAMS)
+
+#define Z1_FUNC_LIST(F, FNR) \
+F(unsigned, z1, , Z1_PARAMS)
+
+IFACE_DEF(Z, , Z_FUNC_LIST)
+
+IFACE_DEF(Z1, , Z1_FUNC_LIST)
+
+IFACE_DEF(Z_X, , Z_X_FUNC_LIST)
+
+IFACE_DEF_FAT(Z_X_fat, , Z_X_FUNC_LIST)
+
+// Conversion from Z_X to Z is static, conversion to Z1 uses the table.
+//
+IFACE_STATIC_CONVERSIONS(Z_X, Z)
+
+IFACE_CONVERSION(Z1, Z1_FUNC_LIST, Z_X)
+
+// Base classes for virtual function calls.
+
+struct Z_v
+  {
+    virtual unsigned z1(unsigned x) = 0;
+
+    virtual void z2(unsigned *acc) = 0;
+
+    virtual ~Z_v() { }
+  };
+
+struct Z_X_v : public Z_v
+  {
+    virtual unsigned x1(unsigned x) = 0;
+  };
+
+// For dynamic_cast (cross cast from Z_X_v).
+//
+struct Y_v
+  {
+    virtual unsigned y1(unsigned x) = 0;
+
+    virtual ~Y_v() { }
+  };
+
+// The classes called.  Since they are final, calls through the IFACE
+// thunks, and the template calls, are direct.
+//
+template <unsigned N>
+class Op final : public Z_X_v, public Y_v
+  {
+  public:
+
+    explicit Op(unsigned k_) : k(k_ * (N + 1)) { }
+
+    unsigned z1(unsigned x) override { return(x + k); }
+
+    void z2(unsigned *acc) override { *acc += k; }
+
+    unsigned x1(unsigned x) override { return(x ^ k); }
+
+    unsigned y1(unsigned x) override { return(x + k); }
+
+  private:
+
+    unsigned k;
+  };
+
+const unsigned Max_classes = 16;
+
+// Z_X interfaces to all the Op classes, so it can be sealed.
+//
+IFACE_SEAL(
+  Z_X, Z_X_FUNC_LIST, Op<0>, Op<1>, Op<2>, Op<3>, Op<4>, Op<5>, Op<6>, Op<7>,
+  Op<8>, Op<9>, Op<10>, Op<11>, Op<12>, Op<13>, Op<14>, Op<15>)
+
+#define ENABLE(N) \
+IFACE_ENABLE(Z_X, Z_X_FUNC_LIST, Op<N>) \
+IFACE_ENABLE(Z_X_fat, Z_X_FUNC_LIST, Op<N>) \
+IFACE_ENABLE(Z1, Z1_FUNC_LIST, Op<N>)
+
+ENABLE(0) ENABLE(1) ENABLE(2) ENABLE(3) ENABLE(4) ENABLE(5) ENABLE(6)
+ENABLE(7) ENABLE(8) ENABLE(9) ENABLE(10) ENABLE(11) ENABLE(12) ENABLE(13)
+ENABLE(14) ENABLE(15)
+
+const unsigned Num_objs = 1024;
+
+const unsigned Reps = 10000;
+
+// The objects, in each of the forms used to call them.
+//
+std::vector<Z_X> h;
+std::vector<Z_X_fat> h_fat;
+Iface_group<Z_X> h_group;
+std::vector<Z_X_v *> h_v;
+std::vector<std::function<unsigned(unsigned)> > h_func;
+
+// The objects of class Op<N>.
+//
+template <unsigned N>
+std::vector<Op<N> *> & of_class()
+  {
+    static std::vector<Op<N> *> v;
+
+    return(v);
+  }
+
+template <unsigned N>
+void make(unsigned k)
+  {
+    Op<N> *p = new Op<N>(k);
+
+    h.push_back(iface_factory<Z_X>(*p));
+    h_fat.push_back(iface_factory<Z_X_fat>(*p));
+    h_group.add(iface_factory<Z_X>(*p));
+    h_v.push_back(p);
+    h_func.push_back([p](unsigned x) { return(p->z1(x)); });
+    of_class<N>().push_back(p);
+  }
+
+template <unsigned N>
+void clear_class() { of_class<N>().clear(); }
+
+#define LIST16(F) \
+F<0>, F<1>, F<2>, F<3>, F<4>, F<5>, F<6>, F<7>, F<8>, F<9>, F<10>, F<11>, \
+F<12>, F<13>, F<14>, F<15>
+
+void (* const Make[Max_classes])(unsigned k) = { LIST16(make) };
+
+void (* const Clear_class[Max_classes])() = { LIST16(clear_class) };
+
+// Delete the objects and empty the arrays.
+//
+void clear()
+  {
+    for (Z_X_v *p : h_v)
+      delete p;
+
+    h.clear();
+    h_fat.clear();
+    h_group.clear();
+    h_v.clear();
+    h_func.clear();
+
+    for (unsigned n = 0; n < Max_classes; ++n)
+      Clear_class[n]();
+  }
+
+// Prevent inlining (and so devirtualization) of the timed functions.
+//
+#define NOINLINE __attribute__((noinline))
+
+NOINLINE unsigned loop_iface()
+  {
+    unsigned x = 0;
+
+    for (unsigned r = 0; r < Reps; ++r)
+      for (const Z_X &i : h)
+        x = IFACE_CALL(i, z1, x);
+
+    return(x);
+  }
+
+NOINLINE unsigned loop_fat()
+  {
+    unsigned x = 0;
+
+    for (unsigned r = 0; r < Reps; ++r)
+      for (const Z_X_fat &i : h_fat)
+        x = IFACE_FAT_CALL(i, z1, x);
+
+    return(x);
+  }
+
+// Uses z2, since the return values of calls by IFACE_CALL_ALL are
+// discarded.
+//
+NOINLINE unsigned loop_group()
+  {
+    unsigned x = 0;
+
+    for (unsigned r = 0; r < Reps; ++r)
+      IFACE_CALL_ALL(h_group, z2, &x);
+
+    return(x);
+  }
+
+NOINLINE unsigned loop_sealed()
+  {
+    unsigned x = 0;
+
+    for (unsigned r = 0; r < Reps; ++r)
+      for (const Z_X &i : h)
+        x = IFACE_SEALED_CALL(i, z1, x);
+
+    return(x);
+  }
+
+NOINLINE unsigned loop_virtual()
+  {
+    unsigned x = 0;
+
+    for (unsigned r = 0; r < Reps; ++r)
+      for (Z_X_v *p : h_v)
+        x = p->z1(x);
+
+    return(x);
+  }
+
+NOINLINE unsigned loop_function()
+  {
+    unsigned x = 0;
+
+    for (unsigned r = 0; r < Reps; ++r)
+      for (const std::function<unsigned(unsigned)> &f : h_func)
+        x = f(x);
+
+    return(x);
+  }
+
+// Call the objects of class Op<N> through Op<Max_classes - 1>.
+//
+template <unsigned N>
+struct Direct
+  {
+    static unsigned call(unsigned x)
+      {
+        for (Op<N> *p : of_class<N>())
+          x = p->z1(x);
+
+        return(Direct<N + 1>::call(x));
+      }
+  };
+
+template <>
+struct Direct<Max_classes>
+  {
+    static unsigned call(unsigned x) { return(x); }
+  };
+
+NOINLINE unsigned loop_template()
+  {
+    unsigned x = 0;
+
+    for (unsigned r = 0; r < Reps; ++r)
+      x = Direct<0>::call(x);
+
+    return(x);
+  }
+
+NOINLINE unsigned loop_convert_static()
+  {
+    unsigned x = 0;
+
+    for (unsigned r = 0; r < Reps; ++r)
+      for (const Z_X &i : h)
+        x = IFACE_CALL(iface_convert<Z>(i), z1, x);
+
+    return(x);
+  }
+
+NOINLINE unsigned loop_convert_table()
+  {
+    unsigned x = 0;
+
+    for (unsigned r = 0; r < Reps; ++r)
+      for (const Z_X &i : h)
+        x = IFACE_CALL(iface_convert<Z1>(i), z1, x);
+
+    return(x);
+  }
+
+NOINLINE unsigned loop_convert_cached()
+  {
+    unsigned x = 0;
+
+    for (unsigned r = 0; r < Reps; ++r)
+      for (const Z_X &i : h)
+        x = IFACE_CALL(IFACE_CONVERT_CACHED(Z1, i), z1, x);
+
+    return(x);
+  }
+
+NOINLINE unsigned loop_query()
+  {
+    unsigned x = 0;
+
+    for (unsigned r = 0; r < Reps; ++r)
+      for (const Z_X &i : h)
+        x = IFACE_CALL(Z1(i.this_, iface_query_vptr<Z1>(i)), z1, x);
+
+    return(x);
+  }
+
+NOINLINE unsigned loop_dynamic_cast()
+  {
+    unsigned x = 0;
+
+    for (unsigned r = 0; r < Reps; ++r)
+      for (Z_X_v *p : h_v)
+        x = dynamic_cast<Y_v *>(p)->y1(x);
+
+    return(x);
+  }
+
+Perf_counters::Counters counters;
+
+unsigned expected;
+
+bool failed;
+
+void time_loop(const char *name, unsigned num_classes, unsigned (*f)())
+  {
+    Perf_counters::Values pc;
+
+    std::chrono::steady_clock::time_point start, stop;
+
+    unsigned x;
+
+    {
+      Perf_counters::Scope s(counters, &pc);
+
+      start = std::chrono::steady_clock::now();
+
+      x = f();
+
+      stop = std::chrono::steady_clock::now();
+    }
+
+    if (x != expected)
+      {
+        std::cout << "FAILED: " << name << '\n';
+
+        failed = true;
+      }
+
+    const double calls = double(Num_objs) * Reps;
+
+    pc = pc.per(calls);
+
+    std::cout << std::left << std::setw(22) << name << std::right
+              << std::setw(8) << num_classes << std::fixed
+              << std::setprecision(3) << std::setw(10)
+              << (std::chrono::duration<double, std::nano>(stop - start).count()
+                  / calls);
+
+    for (Perf_counters::Event e :
+         { Perf_counters::Branch_misses, Perf_counters::Instructions })
+      if (pc.valid[e])
+        std::cout << std::setw(10) << pc.count[e];
+      else
+        std::cout << std::setw(10) << "n/a";
+
+    std::cout << '\n';
+  }
+
+int main()
+  {
+    std::cout << std::left << std::setw(22) << "method" << std::right
+              << std::setw(8) << "classes" << std::setw(10) << "ns/call"
+              << std::setw(10) << "br-miss" << std::setw(10) << "instr"
+              << '\n';
+
+    for (unsigned num_classes : { 1, 2, 4, 16 })
+      {
+        clear();
+
+        expected = 0;
+
+        for (unsigned i = 0; i < Num_objs; ++i)
+          {
+            // Constants depend on rand() so they are not known at compile
+            // time.
+            //
+            Make[unsigned(std::rand()) % num_classes](
+              unsigned(std::rand()) bitor 1);
+          }
+
+        for (Z_X_v *p : h_v)
+          expected = p->z1(expected);
+
+        expected *= Reps;
+
+        time_loop("IFACE_CALL", num_classes, loop_iface);
+        time_loop("IFACE_FAT_CALL", num_classes, loop_fat);
+        time_loop("IFACE_CALL_ALL", num_classes, loop_group);
+        time_loop("IFACE_SEALED_CALL", num_classes, loop_sealed);
+        time_loop("virtual", num_classes, loop_virtual);
+        time_loop("std::function", num_classes, loop_function);
+        time_loop("template", num_classes, loop_template);
+        time_loop("iface_convert static", num_classes, loop_convert_static);
+        time_loop("iface_convert table", num_classes, loop_convert_table);
+        time_loop("IFACE_CONVERT_CACHED", num_classes, loop_convert_cached);
+        time_loop("iface_query_vptr", num_classes, loop_query);
+        time_loop("dynamic_cast", num_classes, loop_dynamic_cast);
+      }
+
+    clear();
+
+    if (!failed)
+      std::cout << "SUCCESS\n";
+
+    return(0);
+  }
@@ -34,7 +34,9 @@ enum Instance
     I_z_x_b_1,
     I_z_x_b_2,
     I_z_y_c_1,
-    I_z_y_c_2
+    I_z_y_c_2,
+    I_w_o,
+    I_w_s
   };
 
 // Identifiers for class member functions in this example.
@@ -66,6 +68,19 @@ FNR(z2, , Z2_PARAMS)
 
 IFACE_DEF(Z, , Z_FUNC_LIST)
 
+// Define interface "Who", which has only the first function of Z.
+
+#define WHO_FUNC_LIST(F, FNR) \
+F(Instance, who, const, IFACE_NO_PARAMS)
+
+IFACE_DEF(Who, , WHO_FUNC_LIST)
+
+// Make the conversion from Z to Who static.  Z is itself the destination of
+// a static conversion (from Z_X, below), so the conversion from Z_X to Who
+// through Z is two loads.
+//
+IFACE_STATIC_CONVERSIONS(Z, Who)
+
 // Exercise a Z interface.
 //
 bool check(Z iface, Instance who, Method z1_result)
@@ -73,6 +88,9 @@ bool check(Z iface, Instance who, Method z1_result)
     if (IFACE_CALL_NP(iface, who) != who)
       return(false);
 
+    if (IFACE_CALL_NP(iface_convert<Who>(iface), who) != who)
+      return(false);
+
     if (IFACE_CALL(iface, z1, nullptr, 0) != z1_result)
       return(false);
 
@@ -100,9 +118,10 @@ FNR(x2, , X2_PARAMS)
 IFACE_DEF(Z_X, , Z_X_FUNC_LIST)
 
 // Since Z_X has Z as a subset, a Z_X instance can be converted to an X
-// instance
+// instance.  Make this conversion static, so no hash table lookup is needed
+// to do it.
 //
-IFACE_CONVERSION(Z, Z_FUNC_LIST, Z_X)
+IFACE_STATIC_CONVERSIONS(Z_X, Z)
 
 // Exercise a Z_X interface.
 //
@@ -134,6 +153,15 @@ IFACE_DEF(V, volatile, V_FUNC_LIST)
 //
 void check(V iface) { IFACE_CALL(iface, v, nullptr); }
 
+// Define a fat version of the V interface.  (Fat interface instances hold
+// their function pointers, rather than pointing to them.)
+
+IFACE_DEF_FAT(V_fat, volatile, V_FUNC_LIST)
+
+// Exercise a V_fat interface.
+//
+void check(V_fat iface) { IFACE_FAT_CALL(iface, v, nullptr); }
+
 class Z_X_A
   {
   private:
@@ -148,7 +176,9 @@ class Z_X_A
 
     Method z1(int *, int) { return(M_a_z_1); }
 
-    void z2(void *) { }
+    // Increment counter, if given.
+    //
+    void z2(void *p) { if (p) ++*static_cast<unsigned *>(p); }
 
     void x2(double) { }
 
@@ -157,12 +187,26 @@ class Z_X_A
     Method x1(int, int) { return(M_a_x_1); }
   };
 
+class Z_X_B;
+
+// The only classes that Z_X interfaces to are Z_X_A and Z_X_B, so Z_X
+// can be sealed.
+//
+IFACE_SEAL(Z_X, Z_X_FUNC_LIST, Z_X_A, Z_X_B)
+
+// Most calls through Z_X are to Z_X_A instances, so its vstructures for
+// Z_X are hot.
+//
+IFACE_HOT(Z_X, Z_X_A)
+
 // Enable Z_X instances to interface to Z_X_A instances.
 //
 IFACE_ENABLE(Z_X, Z_X_FUNC_LIST, Z_X_A)
 
 IFACE_ENABLE(V, V_FUNC_LIST, volatile Z_X_A)
 
+IFACE_ENABLE(V_fat, V_FUNC_LIST, volatile Z_X_A)
+
 class Z_X_B
   {
   private:
@@ -177,7 +221,9 @@ class Z_X_B
 
     Method z1(int *, int) { return(M_b_z_1); }
 
-    void z2(void *) { }
+    // Increment counter, if given.
+    //
+    void z2(void *p) { if (p) ++*static_cast<unsigned *>(p); }
 
     void x2(double) { }
 
@@ -190,6 +236,28 @@ class Z_X_B
 
 IFACE_ENABLE(Z_X, Z_X_FUNC_LIST, Z_X_B)
 
+// Exercise a Z_X interface, with sealed calls (direct calls to member
+// functions, that can be inlined).
+//
+bool check_sealed(
+  Z_X iface, Instance who, Method z1_result, Method x1_result)
+  {
+    if (IFACE_SEALED_CALL_NP(iface, who) != who)
+      return(false);
+
+    if (IFACE_SEALED_CALL(iface, z1, nullptr, 0) != z1_result)
+      return(false);
+
+    IFACE_SEALED_CALL(iface, z2, nullptr);
+
+    if (IFACE_SEALED_CALL(iface, x1, 0, 0) != x1_result)
+      return(false);
+
+    IFACE_SEALED_CALL(iface, x2, 0.0);
+
+    return(true);
+  }
+
 // Define Z_Y interface.
 
 #define Y1_PARAMS(P) \
@@ -213,7 +281,10 @@ IFACE_CONVERSION(Z, Z_FUNC_LIST, Z_Y)
 bool check(
   Z_Y iface, Instance who, Method z1_result, Method y1_result, Method y2_result)
   {
-    if (!check(iface_convert<Z>(iface), who, z1_result))
+    // Normally only one or two classes are interfaced to here, so cache the
+    // conversions.
+    //
+    if (!check(IFACE_CONVERT_CACHED(Z, iface), who, z1_result))
       return(false);
 
     if (IFACE_CALL(iface, y1, 0, 0.0) != y1_result)
@@ -248,6 +319,110 @@ class Z_Y_C
 
 IFACE_ENABLE(Z_Y, Z_Y_FUNC_LIST, Z_Y_C)
 
+#include <memory>
+#include <vector>
+
+// A class that can't be copied, even though std::is_copy_constructible
+// says it can be (the vector's copy constructor is declared, but fails to
+// compile).  Enabling an interface for it must not try to copy it.
+//
+class Who_owner
+  {
+  private:
+
+    std::vector<std::unique_ptr<int> > v;
+
+  public:
+
+    Instance who() const { return(I_w_o); }
+  };
+
+IFACE_ENABLE(Who, WHO_FUNC_LIST, Who_owner)
+
+// A class with a private destructor.  Enabling an interface for it must not
+// try to destroy it.
+//
+class Who_singleton
+  {
+  private:
+
+    Who_singleton() { }
+
+    ~Who_singleton() { }
+
+  public:
+
+    static Who_singleton & instance()
+      {
+        static Who_singleton s;
+
+        return(s);
+      }
+
+    Instance who() const { return(I_w_s); }
+  };
+
+IFACE_ENABLE(Who, WHO_FUNC_LIST, Who_singleton)
+
+// Define interface "Pos", which gives access to data members, as well as
+// a member function.
+
+#define POS_FIELD_LIST(D) \
+D(int, x) \
+D(int, y)
+
+#define POS_FUNC_LIST(F, FNR) \
+F(int, sum, const, IFACE_NO_PARAMS)
+
+IFACE_DEF_FIELDS(Pos, , POS_FUNC_LIST, POS_FIELD_LIST)
+
+// Interface "Pos_y" only gives access to a data member.
+
+#define POS_Y_FIELD_LIST(D) \
+D(int, y)
+
+IFACE_DEF_FIELDS(Pos_y, const, IFACE_NO_FUNCS, POS_Y_FIELD_LIST)
+
+IFACE_CONVERSION(Pos_y, IFACE_NO_FUNCS, Pos)
+
+struct Point
+  {
+    int x, y;
+
+    int sum() const { return(x + y); }
+  };
+
+IFACE_ENABLE_FIELDS(Pos, POS_FUNC_LIST, POS_FIELD_LIST, Point)
+
+// A class with the data members at different offsets.
+//
+struct Labeled_point
+  {
+    char label[3];
+
+    int y, x;
+
+    int sum() const { return(x + y); }
+  };
+
+IFACE_ENABLE_FIELDS(Pos, POS_FUNC_LIST, POS_FIELD_LIST, Labeled_point)
+
+// Exercise a Pos interface.  Data member accesses do not call a function.
+//
+bool check(Pos p)
+  {
+    IFACE_SET(p, x, 3);
+    IFACE_SET(p, y, IFACE_GET(p, x) + 1);
+
+    if (IFACE_CALL_NP(p, sum) != 7)
+      return(false);
+
+    if (IFACE_GET(iface_convert<Pos_y>(p), y) != 4)
+      return(false);
+
+    return(true);
+  }
+
 #include <iostream>
 
 int main()
@@ -258,38 +433,52 @@ int main()
     //
     check(iface_factory<V>(v)); 
 
+    check(iface_factory<V_fat>(v));
+
     Z_X_A z_x_a1(I_z_x_a_1);
 
-    // This call should create a vstructure for Z interfaces to class
-    // Z_X_A instances.
+    // The vstructure for Z interfaces to class Z_X_A instances was
+    // generated at compile time.
     //
     if (!check(iface_factory<Z_X>(z_x_a1), I_z_x_a_1, M_a_z_1, M_a_x_1))
       std::cout << "BAD\n";
 
     Z_X_A z_x_a2(I_z_x_a_2);
 
-    // This call should use the previously created vstructure for Z
-    // interfaces to class Z_X_A instances.
+    // This call should use the same vstructure for Z interfaces to class
+    // Z_X_A instances.
     //
     if (!check(iface_factory<Z_X>(z_x_a2), I_z_x_a_2, M_a_z_1, M_a_x_1))
       std::cout << "BAD\n";
 
     Z_X_B z_x_b1(I_z_x_b_1);
 
-    // This call should create a vstructure for Z interfaces to class
-    // Z_X_B instances.
+    // The vstructure for Z interfaces to class Z_X_B instances was
+    // generated at compile time.
     //
     if (!check(iface_factory<Z_X>(z_x_b1), I_z_x_b_1, M_b_z_1, M_b_x_1))
       std::cout << "BAD\n";
 
     Z_X_B z_x_b2(I_z_x_b_2);
 
-    // This call should use the previously created vstructure for Z
-    // interfaces to class Z_X_B instances.
+    // This call should use the same vstructure for Z interfaces to class
+    // Z_X_B instances.
     //
     if (!check(iface_factory<Z_X>(z_x_b2), I_z_x_b_2, M_b_z_1, M_b_x_1))
       std::cout << "BAD\n";
 
+    if (!check_sealed(iface_factory<Z_X>(z_x_a1), I_z_x_a_1, M_a_z_1,
+                      M_a_x_1) or
+        !check_sealed(iface_factory<Z_X>(z_x_b1), I_z_x_b_1, M_b_z_1,
+                      M_b_x_1))
+      std::cout << "BAD\n";
+
+    // Violate encapsulation to check that sealed calls will not use the
+    // function pointers.
+    //
+    if (iface_factory<Z_X>(z_x_b1).vptr->seal_index != 2)
+      std::cout << "BAD\n";
+
     Z_Y_C z_y_c1(I_z_y_c_1);
 
     // This call should create a vstructure for Z interfaces to class
@@ -309,11 +498,164 @@ int main()
       std::cout << "BAD\n";
 
     // Violate encapsulation to check if reuse of vstructures for conversions
-    // is working as expected.
+    // is working as expected.  (Only the conversions from Z_Y to Z, and from
+    // the created Z vstructure to Who, for Z_Y_C use the map.)
+    //
+    if (Iface_impl::convert_map().size() != 2)
+      std::cout << "BAD\n";
+
+    // Conversion at run time (without the cache) should give the vstructure
+    // created by the first conversion for the class, which is followed by
+    // the one for its static conversion to Who.
+    //
+    {
+      Z z1 = iface_convert<Z>(iface_factory<Z_Y>(z_y_c1)),
+        z2 = iface_convert<Z>(iface_factory<Z_Y>(z_y_c2));
+
+      if ((z1.vptr != z2.vptr) or !check(z2, I_z_y_c_2, M_c_z_1) or
+          (iface_convert<Who>(z1).vptr != iface_convert<Who>(z2).vptr) or
+          (Iface_impl::convert_map().size() != 2))
+        std::cout << "BAD\n";
+    }
+
+    // Static conversion should give the vstructure generated at compile
+    // time.
     //
-    if (Iface_impl::convert_map().size() != 3)
+    if (iface_convert<Z>(iface_factory<Z_X>(z_x_a1)).vptr !=
+        iface_convert<Z>(iface_factory<Z_X>(z_x_a2)).vptr)
       std::cout << "BAD\n";
 
+    // So should chained static conversions.
+    //
+    {
+      Who w1 = iface_convert<Who>(iface_convert<Z>(iface_factory<Z_X>(z_x_a1))),
+          w2 = iface_convert<Who>(iface_convert<Z>(iface_factory<Z_X>(z_x_b1)));
+
+      if ((IFACE_CALL_NP(w1, who) != I_z_x_a_1) or
+          (IFACE_CALL_NP(w2, who) != I_z_x_b_1) or
+          (w1.vptr != iface_convert<Who>(
+                        iface_convert<Z>(iface_factory<Z_X>(z_x_a2))).vptr) or
+          (Iface_impl::convert_map().size() != 2))
+        std::cout << "BAD\n";
+    }
+
+    {
+      Point pt{ 0, 0 };
+      Labeled_point lpt{ "lp", 0, 0 };
+
+      if (!check(iface_factory<Pos>(pt)) or !check(iface_factory<Pos>(lpt)) or
+          (pt.x != 3) or (pt.y != 4) or (lpt.x != 3) or (lpt.y != 4))
+        std::cout << "BAD\n";
+    }
+
+    // Query for interfaces that are not subsets of the source interface.
+    // Z_X is enabled for Z_X_A, Z_Y is not.
+    //
+    {
+      Z z = iface_convert<Z>(iface_factory<Z_X>(z_x_a1));
+
+      const Z_X::Vstruct *vp = iface_query_vptr<Z_X>(z);
+
+      if (!vp or !check(Z_X(z.this_, vp), I_z_x_a_1, M_a_z_1, M_a_x_1) or
+          iface_query_vptr<Z_Y>(z))
+        std::cout << "BAD\n";
+
+      #if __cplusplus >= 201703L
+
+      if (!iface_query<Z_Y>(iface_convert<Z>(iface_factory<Z_Y>(z_y_c1))) or
+          iface_query<Z_X>(iface_convert<Z>(iface_factory<Z_Y>(z_y_c1))))
+        std::cout << "BAD\n";
+
+      #endif
+    }
+
+    // Interfaces to classes that can't be copied or destroyed.
+    //
+    {
+      Who_owner wo;
+
+      if ((IFACE_CALL_NP(iface_factory<Who>(wo), who) != I_w_o) or
+          (IFACE_CALL_NP(iface_factory<Who>(Who_singleton::instance()), who) !=
+             I_w_s))
+        std::cout << "BAD\n";
+    }
+
+    // Boxes own their objects.  Z_X_A and Z_X_B objects fit inline in the
+    // default buffer size, and must be allocated on the heap for a buffer
+    // size of 1.
+    //
+    {
+      std::vector<Iface_box<Z_X> > boxes;
+
+      boxes.push_back(Iface_box<Z_X>::make<Z_X_A>(I_z_x_a_1));
+      boxes.push_back(Iface_box<Z_X>::make<Z_X_B>(I_z_x_b_1));
+
+      Iface_box<Z_X, 1> h = Iface_box<Z_X, 1>::make<Z_X_A>(I_z_x_a_2);
+
+      if (!boxes[0].is_inline() or h.is_inline())
+        std::cout << "BAD\n";
+
+      // Copy and move.
+      //
+      boxes.push_back(boxes[1]);
+
+      Iface_box<Z_X, 1> h2(h), h3(std::move(h));
+
+      if (!h.empty())
+        std::cout << "BAD\n";
+
+      if (!check(boxes[0].get(), I_z_x_a_1, M_a_z_1, M_a_x_1) or
+          !check(boxes[1].get(), I_z_x_b_1, M_b_z_1, M_b_x_1) or
+          !check(boxes[2].get(), I_z_x_b_1, M_b_z_1, M_b_x_1) or
+          !check(h2.get(), I_z_x_a_2, M_a_z_1, M_a_x_1) or
+          !check(h3.get(), I_z_x_a_2, M_a_z_1, M_a_x_1))
+        std::cout << "BAD\n";
+
+      boxes[0] = boxes[2];
+      h2 = std::move(h3);
+
+      if (!check(boxes[0].get(), I_z_x_b_1, M_b_z_1, M_b_x_1) or
+          !check(h2.get(), I_z_x_a_2, M_a_z_1, M_a_x_1) or !h3.empty())
+        std::cout << "BAD\n";
+    }
+
+    // Groups call one class at a time.
+    //
+    {
+      Iface_group<Z_X> g;
+
+      g.add(iface_factory<Z_X>(z_x_a1));
+      g.add(iface_factory<Z_X>(z_x_b1));
+      g.add(iface_factory<Z_X>(z_x_a2));
+      g.add(iface_factory<Z_X>(z_x_b2));
+
+      if ((g.class_groups().size() != 2) or (g.size() != 4))
+        std::cout << "BAD\n";
+
+      unsigned count = 0;
+
+      IFACE_CALL_ALL(g, z2, &count);
+
+      IFACE_CALL_ALL_NP(g, who);
+
+      if (!g.remove(iface_factory<Z_X>(z_x_a1)) or
+          g.remove(iface_factory<Z_X>(z_x_a1)))
+        std::cout << "BAD\n";
+
+      IFACE_CALL_ALL(g, z2, &count);
+
+      if (count != 7)
+        std::cout << "BAD\n";
+
+      // The first group is for Z_X_A, the second for Z_X_B.
+      //
+      for (const auto &cg : g.class_groups())
+        for (auto t : cg.objs)
+          if (IFACE_CALL(Z_X(t, cg.vptr), z1, nullptr, 0) !=
+              (&cg == &g.class_groups()[0] ? M_a_z_1 : M_b_z_1))
+            std::cout << "BAD\n";
+    }
+
     #define X(CLS) \
       std::cout << "sizeof(" << #CLS << ") = " << sizeof(CLS) << '\n';
 
@@ -325,9 +667,19 @@ int main()
 
     X(An_interface_type)
 
+    X(V_fat)
+
+    X(Iface_box<Z_X>)
+
     using A_pointer = Z_Y_C *;
 
     X(A_pointer)
 
+    #ifdef IFACE_PROFILE
+
+    iface_profile_dump(std::cout);
+
+    #endif
+
     return(0);
   }
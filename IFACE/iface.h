@@ -24,8 +24,10 @@ SOFTWARE.
 The primarily intent of this code is to explore the idea of adding
 interfaces to the C++ base language.
 
-It's possible that this facility could be changed to allow class public data
-members to be accessed through interfaces.
+Interfaces can also give access to public data members of the class
+interfaced to (with IFACE_GET and IFACE_SET).  The vstructure holds the
+offset of each data member in the class, so an access is a load or store,
+with no function call.
 
 Definitions:
 
@@ -53,32 +55,129 @@ TYPE specifies the return type of the function (use FNR for void functions).
 NAME is the name of the function.  CV is either blank or a CV type qualifier.
 PARAM_LIST is a param list (defined above) specifying the function parameters.
 
+- A "field list" is a macro that encodes the (public) data members of a
+class that can be accessed through an interface.  It must take (only) one
+parameter.  If the parameter is named D, then the field list must be
+defined as a blank-separated sequence of:
+
+D(TYPE, NAME)
+
+TYPE is the type of the data member, and NAME is its name.  The type of the
+data member in each class interfaced to must be exactly TYPE.  The class
+should be standard layout (offsetof() is used).  IFACE_NO_FIELDS is an
+empty field list.
+
+Conversion between interface types (by iface_convert) is normally done by
+looking up the destination vstructure in a hash table, and creating it
+the first time the conversion is done for a given class.  The hash table is
+thread-safe (it needs MULTI_SPIN_LOCK and SIMPLE_ATOMIC in the include
+path).  Conversions from an interface type can instead be made static
+(with IFACE_STATIC_CONVERSIONS).  Then each source vstructure is followed
+by an array of pointers to the destination vstructures, which for enabled
+classes are all generated at compile time.  So iface_convert() is a single
+load.  The destination vstructures are in turn followed by the pointers for
+the static conversions from the destination interface, so static
+conversions can be chained.
+
+Interface instances do not own the objects they interface to.  Iface_box
+is an interface instance that does own its object (like std::function).
+Small objects are stored in the box, so no heap allocation is needed.  Each
+box also points to operations to copy, move and destroy objects of the
+class, so that boxes can be copied, moved and destroyed.  The operations
+are only generated for classes that boxes are made for, so enabling an
+interface for a class does not require the class to be copyable, movable
+or destructible.
+
+Iface_group holds interface instances grouped by the class interfaced to,
+so IFACE_CALL_ALL can call a member function through all of them with one
+predictable indirect call target per class.
+
+iface_query gets an interface of any type enabled for the class of the
+object interfaced to (not just a subset of the source interface), using a
+table of enabled interfaces kept for each class.
+
+The vstructures generated at compile time are constants, so they are
+placed in read-only data.  Vstructures created at run time (by conversions)
+are packed into pages that are only writable while a vstructure is being
+copied into them (on Unix-like systems with mmap).  Each compile-time
+vstructure is in its own section, named with the mangled name of its
+holder.  IFACE_HOT marks the vstructures for a class and interface as hot.
+When linking with the GNU linker option --sort-section=name, the hot
+vstructures are placed together, before the cold ones, so they take fewer
+cache lines and TLB entries.  If IFACE_PROFILE is defined, calls through
+IFACE_CALL and IFACE_CALL_NP are counted for each vstructure, and
+iface_profile_dump() outputs IFACE_HOT invocations for the most called ones.
+
 */
 
 #ifndef IFACE_20170223
 #define IFACE_20170223
 
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if __cplusplus >= 201703L
+#include <optional>
+#endif
+
+#if defined(__unix__)
+#include <sys/mman.h>
+#endif
+
+#ifdef IFACE_PROFILE
+#include <algorithm>
+#include <ostream>
+#include <string>
+#include <typeinfo>
+#ifdef __GNUC__
+#include <cxxabi.h>
+#endif
+#endif
+
+#include "multi_spin_lock.h"
+
+#if defined(__unix__) && defined(MAP_ANONYMOUS)
+#define IFACE_IMPL_HAVE_MMAP 1
+#else
+#define IFACE_IMPL_HAVE_MMAP 0
+#endif
+
 // Empty param list.
 //
 #define IFACE_NO_PARAMS(P) P(..., ) 
 
+// Empty function list.
+//
+#define IFACE_NO_FUNCS(F, FNR)
+
+// Empty field list.
+//
+#define IFACE_NO_FIELDS(D)
+
 // Defines an interface (type).  IF_NAME is the name of the interface type.
 // CV is a CV type qualifier for the object being interfaced to (not mutable).
 // FUNC_LIST is a function list, specifying the member functions of the
 // interface.
 //
 #define IFACE_DEF(IF_NAME, CV, FUNC_LIST) \
+IFACE_DEF_FIELDS(IF_NAME, CV, FUNC_LIST, IFACE_NO_FIELDS)
+
+// Defines an interface (type) that also gives access to data members.  The
+// parameters are the same as for IFACE_DEF, with the addition of FIELD_LIST,
+// which is a field list specifying the data members of the interface.
+//
+#define IFACE_DEF_FIELDS(IF_NAME, CV, FUNC_LIST, FIELD_LIST) \
  \
 struct IF_NAME \
   { \
     /* Do not access the contents of this directly */ \
  \
-    struct Vstruct \
-      { \
-        FUNC_LIST(IFACE_IMPL_FUNC_POINTER, IFACE_IMPL_FUNC_NR_POINTER) \
- \
-        Iface_impl::Class_id class_id; \
-      }; \
+    IFACE_IMPL_VSTRUCT(FUNC_LIST, FIELD_LIST) \
  \
     CV void * const this_; \
  \
@@ -87,13 +186,46 @@ struct IF_NAME \
     IF_NAME(CV void * t, const Vstruct *vptr_) : this_(t), vptr(vptr_) { } \
   };
 
+// Defines a "fat" interface (type).  The parameters are the same as for
+// IFACE_DEF.  A fat interface instance holds a copy of the vstructure, so
+// calls through it (with IFACE_FAT_CALL) do not have to load the function
+// pointer through the vpointer.  The compiler can keep the function pointer
+// in a register when making calls in a loop.  This is only worthwhile for
+// interfaces with one or two member functions.  Fat interfaces can be used
+// in all the same ways as other interfaces.
+//
+#define IFACE_DEF_FAT(IF_NAME, CV, FUNC_LIST) \
+ \
+struct IF_NAME \
+  { \
+    /* Do not access the contents of this directly */ \
+ \
+    IFACE_IMPL_VSTRUCT(FUNC_LIST, IFACE_NO_FIELDS) \
+ \
+    CV void * const this_; \
+ \
+    const Vstruct * const vptr; \
+ \
+    /* Copy of *vptr. */ \
+    const Vstruct fns; \
+ \
+    IF_NAME(CV void * t, const Vstruct *vptr_) \
+      : this_(t), vptr(vptr_), fns(*vptr_) { } \
+  };
+
 // Enable instance of a class to be interfaced to by instances of an
 // interface.  IF_SPEC is the qualified name of the interface type.
 // FUNC_LIST is the function list that was used to define the interface type.
 // CLS_SPEC is the qualified name of the class.  This can only be invoked
-// at global scope.
+// at global scope.  The vstructure is constant initialized.
 //
 #define IFACE_ENABLE(IF_SPEC, FUNC_LIST, CLS_SPEC) \
+IFACE_ENABLE_FIELDS(IF_SPEC, FUNC_LIST, IFACE_NO_FIELDS, CLS_SPEC)
+
+// Like IFACE_ENABLE, for an interface type defined with IFACE_DEF_FIELDS.
+// FIELD_LIST is the field list that was used to define the interface type.
+//
+#define IFACE_ENABLE_FIELDS(IF_SPEC, FUNC_LIST, FIELD_LIST, CLS_SPEC) \
  \
 namespace Iface_impl \
 { \
@@ -106,21 +238,31 @@ class Enable<IF_SPEC, CLS_SPEC> \
     using Cls = CLS_SPEC; \
  \
     FUNC_LIST(IFACE_IMPL_THUNK, IFACE_IMPL_THUNK_NR) \
+ \
+    FIELD_LIST(IFACE_IMPL_FIELD_CHECK) \
  \
   public: \
  \
-    static const IF_SPEC::Vstruct * vptr() \
+    static constexpr IF_SPEC::Vstruct base() \
       { \
-        static const IF_SPEC::Vstruct IFACE_v = \
-          { \
+        return(IF_SPEC::Vstruct{ \
             FUNC_LIST(IFACE_IMPL_ENB_FUNC_ADDR, \
                       IFACE_IMPL_ENB_FUNC_ADDR_NR) \
  \
-            id<CLS_SPEC>() \
-          }; \
+            FIELD_LIST(IFACE_IMPL_ENB_FIELD) \
  \
-        return(&IFACE_v); \
+            class_id<CLS_SPEC>(), \
+            Seal_index<IF_SPEC, CLS_SPEC>::value \
+          }); \
       } \
+ \
+    static const IF_SPEC::Vstruct * vptr() \
+      { return(&Vstruct_of<Enabled_vstruct<IF_SPEC, CLS_SPEC> >::v.v); } \
+ \
+    /* Causes the vstructure to be added to the class's table for */ \
+    /* iface_query, at dynamic initialization. */ \
+    static bool registered() \
+      { return(Query_registrar<IF_SPEC, CLS_SPEC>::done); } \
   }; \
  \
 }
@@ -129,10 +271,12 @@ class Enable<IF_SPEC, CLS_SPEC> \
 // type (by iface_convert).  DEST_IF_SPEC is the qualified name of the type
 // of the interace instance to be returned by iface_convert.  DEST_FUNC_LIST
 // is the function list used to define the destination destination interface
-// type.  SRC_IF_SPEC is the qualified name of the type of the interface
-// interface that will be the parameter to iface_convert for this conversion.
-// The functions in the destination interface must be a subset of those in
-// the source interface.  This macro can only be invoked at global scope.
+// type (no longer used, kept for compatibility).  SRC_IF_SPEC is the
+// qualified name of the type of the interface interface that will be the
+// parameter to iface_convert for this conversion.  The functions (and
+// fields) in the destination interface must be a subset of those in the
+// source interface.
+// This macro can only be invoked at global scope.
 //
 #define IFACE_CONVERSION(DEST_IF_SPEC, DEST_FUNC_LIST, SRC_IF_SPEC) \
  \
@@ -144,27 +288,77 @@ struct Convert<DEST_IF_SPEC, SRC_IF_SPEC> \
   { \
     static const DEST_IF_SPEC::Vstruct * vptr( \
       const SRC_IF_SPEC::Vstruct *src_vptr) \
-      { \
-        Convert_key k(id<DEST_IF_SPEC>(), src_vptr->class_id); \
+      { return(convert_vptr<DEST_IF_SPEC>(src_vptr)); } \
+  }; \
  \
-        auto map_iter = convert_map().find(k); \
+}
+
+// Make conversions from the interface type SRC_IF_SPEC static.  The
+// variable arguments are the qualified names of the destination interface
+// types.  The functions in each destination interface must be a subset of
+// those in the source interface, and there must be fewer of them.  This
+// macro can only be invoked at global scope, after the destination
+// interface types are defined, and before any invocation of IFACE_ENABLE
+// for the source interface type.  IFACE_CONVERSION is not needed for these
+// conversions.
+//
+#define IFACE_STATIC_CONVERSIONS(SRC_IF_SPEC, ...) \
  \
-        if (map_iter != convert_map().end()) \
-          return(static_cast<const DEST_IF_SPEC::Vstruct *>( \
-            map_iter->second)); \
-        else \
-          { \
-            DEST_IF_SPEC::Vstruct *vp = new DEST_IF_SPEC::Vstruct; \
+namespace Iface_impl \
+{ \
  \
-            DEST_FUNC_LIST(IFACE_IMPL_CONVERT, IFACE_IMPL_CONVERT_NR) \
+template <> \
+struct Static_conversions<SRC_IF_SPEC> \
+  { \
+    using List = Type_list<__VA_ARGS__>; \
+  }; \
  \
-            vp->class_id = src_vptr->class_id; \
+}
+
+// Mark the vstructures for interface type IF_SPEC and class CLS_SPEC as hot,
+// so they are placed together, before other vstructures (see
+// Vstruct_holder).  This macro can only be invoked at global scope, before
+// the invocation of IFACE_ENABLE for the interface type and class.  The
+// invocations are normally in a header generated by iface_profile_dump().
+//
+#define IFACE_HOT(IF_SPEC, CLS_SPEC) \
  \
-            convert_map()[k] = vp; \
+namespace Iface_impl \
+{ \
  \
-            return(vp); \
-          }; \
-      } \
+template <> \
+struct Hot<IF_SPEC, CLS_SPEC> : std::true_type { }; \
+ \
+}
+
+// Seal the interface type IF_SPEC, for the classes whose qualified names
+// are the variable arguments.  FUNC_LIST is the function list that was
+// used to define the interface type.  Calls made with IFACE_SEALED_CALL,
+// through an instance interfacing to one of these classes, are made by
+// selecting the class with a (dense) index in the vstructure, and then
+// calling the member function directly.  So the member function can be
+// inlined (like with std::visit for a variant).  Calls through instances
+// interfacing to other classes (or whose vstructure was created by
+// iface_convert at run time) are made through the function pointer.  This
+// macro can only be invoked at global scope, after the classes are
+// declared, and before any invocation of IFACE_ENABLE for the interface
+// type.  The classes must be complete where IFACE_SEALED_CALL is used.
+//
+#define IFACE_SEAL(IF_SPEC, FUNC_LIST, ...) \
+ \
+namespace Iface_impl \
+{ \
+ \
+template <> \
+struct Sealed<IF_SPEC> \
+  { \
+    using List = Type_list<__VA_ARGS__>; \
+ \
+    using Iface = IF_SPEC; \
+ \
+    using Vstruct = IF_SPEC::Vstruct; \
+ \
+    FUNC_LIST(IFACE_IMPL_SEAL_FUNC, IFACE_IMPL_SEAL_FUNC_NR) \
   }; \
  \
 }
@@ -173,12 +367,100 @@ struct Convert<DEST_IF_SPEC, SRC_IF_SPEC> \
 // variable arguments must be the member function's actual arguments.
 //
 #define IFACE_CALL(IF_INST, NAME, ...) \
-(IF_INST).vptr->NAME((IF_INST).this_, __VA_ARGS__)
+(IFACE_IMPL_PROFILE(IF_INST) (IF_INST).vptr->NAME((IF_INST).this_, __VA_ARGS__))
+
+// Call the member function NAME, which takes no arguments, through the
+// interface instance IF_INST.
+//
+#define IFACE_CALL_NP(IF_INST, NAME) \
+(IFACE_IMPL_PROFILE(IF_INST) (IF_INST).vptr->NAME((IF_INST).this_))
+
+// Call the member function NAME through the interface instance IF_INST, whose
+// type was sealed with IFACE_SEAL.  The variable arguments must be the member
+// function's actual arguments.
+//
+#define IFACE_SEALED_CALL(IF_INST, NAME, ...) \
+Iface_impl::Seal_dispatch< \
+  typename Iface_impl::Sealed<Iface_impl::Decay<decltype(IF_INST)> >::NAME \
+>::call((IF_INST), __VA_ARGS__)
+
+// Call the member function NAME, which takes no arguments, through the
+// interface instance IF_INST, whose type was sealed with IFACE_SEAL.
+//
+#define IFACE_SEALED_CALL_NP(IF_INST, NAME) \
+Iface_impl::Seal_dispatch< \
+  typename Iface_impl::Sealed<Iface_impl::Decay<decltype(IF_INST)> >::NAME \
+>::call(IF_INST)
+
+// Call the member function NAME through the fat interface instance IF_INST.
+// The variable arguments must be the member function's actual arguments.
+//
+#define IFACE_FAT_CALL(IF_INST, NAME, ...) \
+(IF_INST).fns.NAME((IF_INST).this_, __VA_ARGS__)
 
 // Call the member function NAME, which takes no arguments, through the
+// fat interface instance IF_INST.
+//
+#define IFACE_FAT_CALL_NP(IF_INST, NAME) (IF_INST).fns.NAME((IF_INST).this_)
+
+// Call the member function NAME through each interface instance in the
+// Iface_group GROUP, one class at a time.  The function pointer is loaded
+// once per class.  The variable arguments must be the member function's
+// actual arguments.  The return values are discarded.  This is a statement.
+//
+#define IFACE_CALL_ALL(GROUP, NAME, ...) \
+do \
+  { \
+    for (const auto &iface_impl_cg : (GROUP).class_groups()) \
+      { \
+        const auto iface_impl_fp = iface_impl_cg.vptr->NAME; \
+ \
+        for (auto iface_impl_t : iface_impl_cg.objs) \
+          iface_impl_fp(iface_impl_t, __VA_ARGS__); \
+      } \
+  } \
+while (false)
+
+// Like IFACE_CALL_ALL, for a member function that takes no arguments.
+//
+#define IFACE_CALL_ALL_NP(GROUP, NAME) \
+do \
+  { \
+    for (const auto &iface_impl_cg : (GROUP).class_groups()) \
+      { \
+        const auto iface_impl_fp = iface_impl_cg.vptr->NAME; \
+ \
+        for (auto iface_impl_t : iface_impl_cg.objs) \
+          iface_impl_fp(iface_impl_t); \
+      } \
+  } \
+while (false)
+
+// The data member NAME of the object interfaced to by the interface instance
+// IF_INST (an lvalue, with the CV qualifier of the interface).
+//
+#define IFACE_GET(IF_INST, NAME) \
+(*Iface_impl::field_ptr((IF_INST).this_, (IF_INST).vptr->NAME))
+
+// Assign VALUE to the data member NAME of the object interfaced to by the
 // interface instance IF_INST.
 //
-#define IFACE_CALL_NP(IF_INST, NAME) (IF_INST).vptr->NAME((IF_INST).this_)
+#define IFACE_SET(IF_INST, NAME, VALUE) (IFACE_GET(IF_INST, NAME) = (VALUE))
+
+// Convert the interface instance SRC_IF_INST to one of type DEST_IF_SPEC,
+// like iface_convert(), but with a cache, at the point where the macro is
+// invoked, of the conversions done there for up to four different classes.
+// If the class of the instance interfaced to is in the cache, the
+// conversion is a comparison and a load.  Use this where there are few
+// different classes, for conversions that are not static.
+//
+#define IFACE_CONVERT_CACHED(DEST_IF_SPEC, SRC_IF_INST) \
+([](Iface_impl::Decay<decltype(SRC_IF_INST)> iface_src) -> DEST_IF_SPEC \
+  { \
+    static Iface_impl::Convert_cache<DEST_IF_SPEC> iface_cache; \
+ \
+    return(iface_cache.convert(iface_src)); \
+  }(SRC_IF_INST))
 
 namespace Iface_impl
 {
@@ -191,6 +473,110 @@ class Enable;
 template <class Dest_iface, class Src_iface>
 class Convert;
 
+// Operations to copy, move and destroy objects of a class, without knowing
+// the class.  The move function is null if the class does not have a
+// non-throwing move constructor.
+//
+struct Obj_ops
+  {
+    std::size_t size, align;
+
+    // Call destructor of object.
+    //
+    void (*destroy)(void *obj);
+
+    // Copy construct object at dest.
+    //
+    void (*copy)(void *dest, const void *src);
+
+    // Move construct object at dest.
+    //
+    void (*move)(void *dest, void *src);
+  };
+
+template <class Cls,
+          bool Enable = std::is_nothrow_move_constructible<Cls>::value>
+struct Move_op
+  {
+    static void move(void *dest, void *src)
+      { ::new (dest) Cls(std::move(*static_cast<Cls *>(src))); }
+
+    static constexpr void (*f)(void *, void *) = &move;
+  };
+
+template <class Cls>
+struct Move_op<Cls, false>
+  {
+    static constexpr void (*f)(void *, void *) = nullptr;
+  };
+
+template <class Cls>
+struct Obj_ops_for
+  {
+    static void destroy(void *obj) { static_cast<Cls *>(obj)->~Cls(); }
+
+    static void copy(void *dest, const void *src)
+      { ::new (dest) Cls(*static_cast<const Cls *>(src)); }
+
+    static constexpr Obj_ops ops =
+      { sizeof(Cls), alignof(Cls), &destroy, &copy, Move_op<Cls>::f };
+  };
+
+template <class Cls>
+constexpr Obj_ops Obj_ops_for<Cls>::ops;
+
+template <class ... Ts>
+struct Type_list { };
+
+// Specialized by IFACE_STATIC_CONVERSIONS.
+//
+template <class Src_iface>
+struct Static_conversions
+  {
+    using List = Type_list<>;
+  };
+
+// Specialized by IFACE_HOT.
+//
+template <class Iface, class Cls>
+struct Hot : std::false_type { };
+
+// Specialized by IFACE_SEAL.
+//
+template <class Iface>
+struct Sealed
+  {
+    using List = Type_list<>;
+  };
+
+// "value" is the index of Dest in the list, or -1 if it's not in the list.
+//
+template <class Dest, class List>
+struct Index_of
+  {
+    static const int value = -1;
+  };
+
+template <class Dest, class ... Rest>
+struct Index_of<Dest, Type_list<Dest, Rest...> >
+  {
+    static const int value = 0;
+  };
+
+template <class Dest, class First, class ... Rest>
+struct Index_of<Dest, Type_list<First, Rest...> >
+  {
+    static const int value =
+      Index_of<Dest, Type_list<Rest...> >::value < 0 ?
+        -1 : 1 + Index_of<Dest, Type_list<Rest...> >::value;
+  };
+
+template <class Dest_iface, class Src_iface, int Static_idx>
+struct Convert_vptr;
+
+template <class C>
+constexpr int * id();
+
 } // end namespace Iface_impl
 
 // Return an interface instance of type Iface that interfaces to an
@@ -200,6 +586,40 @@ template <class Iface, class Target>
 Iface iface_factory(Target &t)
   { return(Iface(&t, Iface_impl::Enable<Iface, Target>::vptr())); }
 
+// Returns the vpointer for an interface of type Dest_iface, to the object
+// interfaced to by an interface instance of type Src_iface, if Dest_iface
+// is enabled for the class of the object.  Otherwise returns null.  Unlike
+// iface_convert(), the functions of Dest_iface do not have to be a subset
+// of those of Src_iface (like a type assertion in Go).  The class's table
+// of interfaces is filled in at dynamic initialization, so iface_query
+// should not be used before main() is entered.
+//
+template <class Dest_iface, class Src_iface>
+const typename Dest_iface::Vstruct * iface_query_vptr(Src_iface src_if)
+  {
+    return(
+      static_cast<const typename Dest_iface::Vstruct *>(
+        src_if.vptr->class_id->find(Iface_impl::id<Dest_iface>())));
+  }
+
+#if __cplusplus >= 201703L
+
+// Like iface_query_vptr(), but returns an optional interface instance.
+//
+template <class Dest_iface, class Src_iface>
+std::optional<Dest_iface> iface_query(Src_iface src_if)
+  {
+    const typename Dest_iface::Vstruct *vp =
+      iface_query_vptr<Dest_iface>(src_if);
+
+    if (!vp)
+      return(std::nullopt);
+
+    return(Dest_iface(src_if.this_, vp));
+  }
+
+#endif
+
 // Convert an interface instance of type Src_iface to one of type Dest_iface.
 //
 template <class Dest_iface, class Src_iface>
@@ -208,138 +628,1440 @@ Dest_iface iface_convert(Src_iface src_if)
     return(
       Dest_iface(
         src_if.this_,
-        Iface_impl::Convert<Dest_iface, Src_iface>::vptr(src_if.vptr)));
+        Iface_impl::Convert_vptr<
+          Dest_iface, Src_iface,
+          Iface_impl::Index_of<
+            Dest_iface,
+            typename Iface_impl::Static_conversions<Src_iface>::List>::value
+        >::get(src_if.vptr)));
   }
 
-/*
+// An interface instance that owns the object it interfaces to.  Objects
+// whose size is no more than Buf_size, whose alignment is no more than that
+// of std::max_align_t, and that have a non-throwing move constructor, are
+// stored inline in the box (no heap allocation).  Other objects are
+// allocated on the heap.  Copying a box copies the object, so (as for
+// std::any) the class must be copy constructible, and its copy constructor
+// must compile.  Moving a box with a heap-allocated object just moves the
+// pointer.  The class must have an accessible destructor.
+//
+template <class Iface, std::size_t Buf_size = 4 * sizeof(void *)>
+class Iface_box
+  {
+  public:
 
-Bad implementation artifcats of this facility include:
+    Iface_box() : vptr(nullptr), ops(nullptr), obj(nullptr) { }
 
-- No member function name overloading in interfaces.
+    // Create a box holding an object of class Cls, constructed with the
+    // given arguments.  Iface must be enabled for Cls.
+    //
+    template <class Cls, class ... Args>
+    static Iface_box make(Args && ... args)
+      {
+        static_assert(alignof(Cls) <= alignof(std::max_align_t),
+                      "Iface_box: class is over-aligned");
 
-- If you call a parameterless interface function with parameters, they
-will be ignored at run-time, but you will not get a compile error.
+        static_assert(std::is_copy_constructible<Cls>::value,
+                      "Iface_box: class is not copy constructible");
 
-*/
+        Iface_box b;
 
-// ----- Private stuff (don't use directly) --------------------------
+        b.obj =
+          b.template place<Cls>(
+            std::integral_constant<bool, fits<Cls>()>(),
+            std::forward<Args>(args)...);
 
-#define IFACE_IMPL_FUNC_POINTER(TYPE, NAME, CV, PARAMS) \
-TYPE (*NAME) (CV void *this_, PARAMS(IFACE_IMPL_FULL_PARAM) );
+        b.vptr = Iface_impl::Enable<Iface, Cls>::vptr();
 
-#define IFACE_IMPL_FUNC_NR_POINTER(NAME, CV, PARAMS) \
-IFACE_IMPL_FUNC_POINTER(void, NAME, CV, PARAMS)
+        b.ops = &Iface_impl::Obj_ops_for<Cls>::ops;
 
-#define IFACE_IMPL_THUNK(TYPE, NAME, CV, PARAMS) \
-static TYPE NAME(CV void *this_, PARAMS(IFACE_IMPL_FULL_PARAM) ) \
-  { \
-    return( \
-      static_cast<CV Cls *>(this_)->NAME( PARAMS(IFACE_IMPL_PARAM_NAME) )); \
-  }
+        return(b);
+      }
 
-#define IFACE_IMPL_THUNK_NR(NAME, CV, PARAMS) \
-static void NAME(CV void *this_, PARAMS(IFACE_IMPL_FULL_PARAM) ) \
-  { \
-    static_cast<CV Cls *>(this_)->NAME( PARAMS(IFACE_IMPL_PARAM_NAME) ); \
-  }
+    Iface_box(const Iface_box &b) : vptr(nullptr), ops(nullptr), obj(nullptr)
+      { copy_from(b); }
 
-#define IFACE_IMPL_CONVERT(TYPE, NAME, CV, PARAMS) \
-vp->NAME = src_vptr->NAME;
+    Iface_box(Iface_box &&b) noexcept
+      : vptr(nullptr), ops(nullptr), obj(nullptr)
+      { move_from(b); }
 
-#define IFACE_IMPL_CONVERT_NR(NAME, CV, PARAMS) \
-IFACE_IMPL_CONVERT(, NAME, , PARAMS)
+    Iface_box & operator = (const Iface_box &b)
+      {
+        if (this != &b)
+          {
+            Iface_box t(b);
 
-#define IFACE_IMPL_ENB_FUNC_ADDR(TYPE, NAME, CV, PARAMS) NAME,
+            reset();
 
-#define IFACE_IMPL_ENB_FUNC_ADDR_NR(NAME, CV, PARAMS) NAME,
+            move_from(t);
+          }
 
-#define IFACE_IMPL_FULL_PARAM(TYPE, NAME) TYPE NAME
+        return(*this);
+      }
 
-#define IFACE_IMPL_PARAM_NAME(TYPE, NAME) NAME
+    Iface_box & operator = (Iface_box &&b) noexcept
+      {
+        if (this != &b)
+          {
+            reset();
 
-#include <functional>
-#include <unordered_map>
+            move_from(b);
+          }
 
-namespace Iface_impl
-{
+        return(*this);
+      }
 
-template <class C>
-int * id()
-  {
-    // Dummy, purpose is to provide a unique address for each class C.
-    static int i;
+    ~Iface_box() { reset(); }
 
-    return(&i);
-  }
+    bool empty() const { return(!vptr); }
 
-using Class_id = int *;
+    // The box must not be empty.
+    //
+    Iface get() const { return(Iface(obj, vptr)); }
 
-using Iface_id = int *;
+    // Destroy the object (if any), leaving the box empty.
+    //
+    void reset() noexcept
+      {
+        if (vptr)
+          {
+            ops->destroy(obj);
+
+            if (obj != buf)
+              ::operator delete(obj);
+
+            vptr = nullptr;
+            ops = nullptr;
+            obj = nullptr;
+          }
+      }
+
+    // True if the object is stored inline.
+    //
+    bool is_inline() const { return(vptr and (obj == buf)); }
 
-// Key for lookup table from interface type / class type combo to a pointer
-// to a pointer to the vstructure for the class for that interface.
-//
-class Convert_key
-  {
   private:
 
-    // ID of interface resulting from interface conversion.
-    const Iface_id dest_iface_id;
+    // Null if empty.
+    //
+    const typename Iface::Vstruct *vptr;
 
-    // ID of class of instance interfaced to.
-    const Class_id class_id;
+    // Operations for the class of the object.  Null if empty.
+    //
+    const Iface_impl::Obj_ops *ops;
 
-  public:
+    // Points to buf or to heap.
+    //
+    void *obj;
 
-    Convert_key(Iface_id i, Class_id c) : dest_iface_id(i), class_id(c) { }
+    alignas(std::max_align_t) unsigned char buf[Buf_size];
+
+    template <class Cls>
+    static constexpr bool fits()
+      {
+        return((sizeof(Cls) <= Buf_size) and
+               std::is_nothrow_move_constructible<Cls>::value);
+      }
 
-    // "Pre-hash" this instance to produce a value of a type for which
-    // std::hash is already defined.  Hopefully never a loss of nominal
-    // or actual precision in any C++ implementation.
+    // Construct object in buf.
     //
-    long long hash_me() const { return(dest_iface_id - class_id); }
+    template <class Cls, class ... Args>
+    void * place(std::true_type, Args && ... args)
+      {
+        ::new (buf) Cls(std::forward<Args>(args)...);
 
-    friend bool operator == (Convert_key a, Convert_key b)
-      { return((a.dest_iface_id == b.dest_iface_id) and
-               (a.class_id == b.class_id)); }
-  };
+        return(buf);
+      }
 
-} // end namespace Iface_impl
+    // Construct object on heap.
+    //
+    template <class Cls, class ... Args>
+    static void * place(std::false_type, Args && ... args)
+      {
+        void *p = ::operator new(sizeof(Cls));
 
-namespace std
-{
+        try
+          {
+            ::new (p) Cls(std::forward<Args>(args)...);
+          }
+        catch (...)
+          {
+            ::operator delete(p);
 
-template<>
-struct hash<Iface_impl::Convert_key>
-  {
-    using argument_type = Iface_impl::Convert_key;
+            throw;
+          }
 
-    using result_type = std::size_t;
+        return(p);
+      }
 
-    result_type operator()(const argument_type &k) const
+    // This box must be empty.
+    //
+    void copy_from(const Iface_box &b)
       {
-        return(std::hash<long long>()(k.hash_me()));
+        if (!b.vptr)
+          return;
+
+        if (b.obj == b.buf)
+          {
+            b.ops->copy(buf, b.obj);
+
+            obj = buf;
+          }
+        else
+          {
+            void *p = ::operator new(b.ops->size);
+
+            try
+              {
+                b.ops->copy(p, b.obj);
+              }
+            catch (...)
+              {
+                ::operator delete(p);
+
+                throw;
+              }
+
+            obj = p;
+          }
+
+        vptr = b.vptr;
+        ops = b.ops;
       }
-  };
 
-} // end namespace std
+    // This box must be empty.  b is left empty.
+    //
+    void move_from(Iface_box &b) noexcept
+      {
+        if (!b.vptr)
+          return;
 
-namespace Iface_impl
-{
+        if (b.obj == b.buf)
+          {
+            // Only objects with a non-throwing move constructor are
+            // stored inline.
+            //
+            b.ops->move(buf, b.obj);
 
-using Convert_map = std::unordered_map<Convert_key, const void *>;
+            b.ops->destroy(b.obj);
 
-// Map to get vpointer for result (destination) interface in interface
-// conversion.
+            obj = buf;
+          }
+        else
+          obj = b.obj;
+
+        vptr = b.vptr;
+        ops = b.ops;
+
+        b.vptr = nullptr;
+        b.ops = nullptr;
+        b.obj = nullptr;
+      }
+  };
+
+// A collection of interface instances, kept partitioned by the class of
+// the object interfaced to.  Calls to all the instances (with
+// IFACE_CALL_ALL) are made one class at a time, so each indirect call
+// site only has one target for a run of calls, which the branch predictor
+// predicts well, and only one class's member function is being executed
+// (keeping it in the instruction cache).  The order of calls is not the
+// order in which the instances were added.
 //
-inline Convert_map & convert_map()
+template <class Iface>
+class Iface_group
   {
-    static Convert_map m;
+  public:
 
-    return(m);
-  }
+    using This_ptr =
+      typename std::remove_const<decltype(Iface::this_)>::type;
 
-} // end namespace Iface_impl
+    // The instances for one class.
+    //
+    struct Class_group
+      {
+        const typename Iface::Vstruct *vptr;
+
+        std::vector<This_ptr> objs;
+      };
+
+    void add(Iface i) { group_for(i.vptr).objs.push_back(i.this_); }
+
+    // Remove an instance (that was previously added).  The order of the
+    // remaining instances of its class may change.  Returns false if the
+    // instance is not in the group.
+    //
+    bool remove(Iface i)
+      {
+        for (Class_group &cg : groups)
+          if (cg.vptr->class_id == i.vptr->class_id)
+            {
+              for (This_ptr &t : cg.objs)
+                if (t == i.this_)
+                  {
+                    t = cg.objs.back();
+
+                    cg.objs.pop_back();
+
+                    return(true);
+                  }
+
+              break;
+            }
+
+        return(false);
+      }
+
+    std::size_t size() const
+      {
+        std::size_t n = 0;
+
+        for (const Class_group &cg : groups)
+          n += cg.objs.size();
+
+        return(n);
+      }
+
+    // Remove all instances.  (Storage for the classes already seen is kept.)
+    //
+    void clear()
+      {
+        for (Class_group &cg : groups)
+          cg.objs.clear();
+      }
+
+    const std::vector<Class_group> & class_groups() const { return(groups); }
+
+  private:
+
+    // In order of first addition of an instance of the class.  Linear
+    // search is fast, since there are typically few classes.
+    //
+    std::vector<Class_group> groups;
+
+    Class_group & group_for(const typename Iface::Vstruct *vptr)
+      {
+        for (Class_group &cg : groups)
+          if (cg.vptr->class_id == vptr->class_id)
+            return(cg);
+
+        groups.push_back(Class_group{ vptr, std::vector<This_ptr>() });
+
+        return(groups.back());
+      }
+  };
+
+/*
+
+Bad implementation artifcats of this facility include:
+
+- No member function name overloading in interfaces.
+
+- If you call a parameterless interface function with parameters, they
+will be ignored at run-time, but you will not get a compile error.
+
+*/
+
+// ----- Private stuff (don't use directly) --------------------------
+
+#define IFACE_IMPL_VSTRUCT(FUNC_LIST, FIELD_LIST) \
+ \
+struct Vstruct \
+  { \
+    FUNC_LIST(IFACE_IMPL_FUNC_POINTER, IFACE_IMPL_FUNC_NR_POINTER) \
+ \
+    FIELD_LIST(IFACE_IMPL_FIELD) \
+ \
+    Iface_impl::Class_id class_id; \
+ \
+    /* One plus index of class in the list given to IFACE_SEAL (zero */ \
+    /* if not sealed). */ \
+    unsigned seal_index; \
+  }; \
+ \
+/* Vstruct for the same class as the vstruct of another interface, */ \
+/* whose functions and fields must be a superset of those of this one. */ \
+template <class Src_vstruct> \
+static constexpr Vstruct vstruct_from( \
+  const Src_vstruct &src, unsigned seal_index = 0) \
+  { \
+    return(Vstruct{ \
+      FUNC_LIST(IFACE_IMPL_FROM, IFACE_IMPL_FROM_NR) \
+      FIELD_LIST(IFACE_IMPL_FIELD_FROM) \
+      src.class_id, seal_index }); \
+  }
+
+#define IFACE_IMPL_FUNC_POINTER(TYPE, NAME, CV, PARAMS) \
+TYPE (*NAME) (CV void *this_, PARAMS(IFACE_IMPL_FULL_PARAM) );
+
+#define IFACE_IMPL_FUNC_NR_POINTER(NAME, CV, PARAMS) \
+IFACE_IMPL_FUNC_POINTER(void, NAME, CV, PARAMS)
+
+#define IFACE_IMPL_THUNK(TYPE, NAME, CV, PARAMS) \
+static TYPE NAME(CV void *this_, PARAMS(IFACE_IMPL_FULL_PARAM) ) \
+  { \
+    return( \
+      static_cast<CV Cls *>(this_)->NAME( PARAMS(IFACE_IMPL_PARAM_NAME) )); \
+  }
+
+#define IFACE_IMPL_THUNK_NR(NAME, CV, PARAMS) \
+static void NAME(CV void *this_, PARAMS(IFACE_IMPL_FULL_PARAM) ) \
+  { \
+    static_cast<CV Cls *>(this_)->NAME( PARAMS(IFACE_IMPL_PARAM_NAME) ); \
+  }
+
+#define IFACE_IMPL_FROM(TYPE, NAME, CV, PARAMS) src.NAME,
+
+#define IFACE_IMPL_FROM_NR(NAME, CV, PARAMS) src.NAME,
+
+#define IFACE_IMPL_ENB_FUNC_ADDR(TYPE, NAME, CV, PARAMS) NAME,
+
+#define IFACE_IMPL_ENB_FUNC_ADDR_NR(NAME, CV, PARAMS) NAME,
+
+// Functions to call member function NAME, directly for a given class, or
+// through the vstructure.
+//
+#define IFACE_IMPL_SEAL_FUNC(TYPE, NAME, CV, PARAMS) \
+struct NAME \
+  { \
+    using Iface = Sealed::Iface; \
+ \
+    using Ret = TYPE; \
+ \
+    template <class Cls, class ... Args> \
+    static TYPE direct(CV void *this_, Args && ... args) \
+      { \
+        return( \
+          static_cast<CV Cls *>(this_)->NAME(std::forward<Args>(args)...)); \
+      } \
+ \
+    template <class ... Args> \
+    static TYPE indirect( \
+      const Vstruct *vptr, CV void *this_, Args && ... args) \
+      { return(vptr->NAME(this_, std::forward<Args>(args)...)); } \
+  };
+
+#define IFACE_IMPL_SEAL_FUNC_NR(NAME, CV, PARAMS) \
+IFACE_IMPL_SEAL_FUNC(void, NAME, CV, PARAMS)
+
+#define IFACE_IMPL_FIELD(TYPE, NAME) Iface_impl::Field<TYPE> NAME;
+
+#define IFACE_IMPL_FIELD_CHECK(TYPE, NAME) \
+static_assert( \
+  std::is_same<decltype(Remove_cv<Cls>::NAME), TYPE>::value, \
+  "type of data member " #NAME " does not match interface");
+
+#define IFACE_IMPL_ENB_FIELD(TYPE, NAME) \
+Field<TYPE>{ offsetof(Remove_cv<Cls>, NAME) },
+
+#define IFACE_IMPL_FIELD_FROM(TYPE, NAME) src.NAME,
+
+#define IFACE_IMPL_FULL_PARAM(TYPE, NAME) TYPE NAME
+
+#ifdef IFACE_PROFILE
+#define IFACE_IMPL_PROFILE(IF_INST) Iface_impl::profile_count((IF_INST).vptr),
+#else
+#define IFACE_IMPL_PROFILE(IF_INST)
+#endif
+
+#define IFACE_IMPL_PARAM_NAME(TYPE, NAME) NAME
+
+namespace Iface_impl
+{
+
+template <class C>
+struct Id_holder
+  {
+    // Dummy, purpose is to provide a unique address for each class C.
+    static int i;
+  };
+
+template <class C>
+int Id_holder<C>::i;
+
+template <class C>
+constexpr int * id() { return(&Id_holder<C>::i); }
+
+using Iface_id = int *;
+
+// Table from interface IDs to the vstructures, for one class, of the
+// interfaces enabled for the class.  Uses a multiply-shift hash, with the
+// multiplier chosen so that there are no collisions (a perfect hash).  So a
+// lookup is a multiply, a shift, a load and a compare.
+//
+struct Query_table
+  {
+    struct Entry
+      {
+        Iface_id iface;
+
+        const void *vptr;
+      };
+
+    std::uint64_t mult;
+
+    // 64 minus log base 2 of the number of slots.
+    //
+    unsigned shift;
+
+    std::vector<Entry> slot;
+
+    std::size_t index(Iface_id i) const
+      {
+        return(
+          std::size_t((mult * std::uint64_t(std::uintptr_t(i))) >> shift));
+      }
+
+    // Returns null if the interface is not in the table.
+    //
+    const void * find(Iface_id i) const
+      {
+        const Entry &e = slot[index(i)];
+
+        return(e.iface == i ? e.vptr : nullptr);
+      }
+
+    // Returns null if no multiplier is found with no collisions for a
+    // table of 2 to the power "bits" slots.
+    //
+    static Query_table * make(const std::vector<Entry> &entries, unsigned bits)
+      {
+        // Sequence of pseudo-random odd multipliers (splitmix64).
+        //
+        std::uint64_t seed = 0;
+
+        for (unsigned tries = 0; tries < 64; ++tries)
+          {
+            std::uint64_t m = (seed += 0x9e3779b97f4a7c15ULL);
+
+            m = (m ^ (m >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            m = (m ^ (m >> 27)) * 0x94d049bb133111ebULL;
+            m = (m ^ (m >> 31)) bitor 1;
+
+            Query_table *t = new Query_table;
+
+            t->mult = m;
+            t->shift = 64 - bits;
+            t->slot.assign(std::size_t(1) << bits, Entry{ nullptr, nullptr });
+
+            bool collision = false;
+
+            for (const Entry &e : entries)
+              {
+                Entry &s = t->slot[t->index(e.iface)];
+
+                if (s.iface)
+                  {
+                    collision = true;
+
+                    break;
+                  }
+
+                s = e;
+              }
+
+            if (!collision)
+              return(t);
+
+            delete t;
+          }
+
+        return(nullptr);
+      }
+  };
+
+// Lock for adding entries to the query table of any class.
+//
+inline Multi_spin_lock<> & query_lock()
+  {
+    static Multi_spin_lock<> l;
+
+    return(l);
+  }
+
+// Information about a class.  Constant initialized.
+//
+class Class_info
+  {
+  public:
+
+    constexpr Class_info() : table(Simple_atomic::No_threads) { }
+
+    Class_info(const Class_info &) = delete;
+    Class_info & operator = (const Class_info &) = delete;
+
+    // Returns the vstructure of the interface (as void pointer), or null
+    // if the interface is not enabled for the class (or has not been
+    // added yet).
+    //
+    const void * find(Iface_id i) const
+      {
+        const Query_table *t = table;
+
+        if (!t)
+          return(nullptr);
+
+        Simple_atomic::acquire();
+
+        return(t->find(i));
+      }
+
+    // Add an enabled interface.  Readers may be using the old table, so it
+    // is not freed.  This is only expected to be done at initialization,
+    // for a few interfaces per class, so the time to find a perfect hash
+    // does not matter.
+    //
+    void insert(Iface_id i, const void *vptr)
+      {
+        Multi_spin_lock<>::Sentry sentry(query_lock());
+
+        std::vector<Query_table::Entry> entries;
+
+        const Query_table *t = table;
+
+        if (t)
+          for (const Query_table::Entry &e : t->slot)
+            if (e.iface)
+              {
+                // Enabled in more than one translation unit.
+                //
+                if (e.iface == i)
+                  return;
+
+                entries.push_back(e);
+              }
+
+        entries.push_back(Query_table::Entry{ i, vptr });
+
+        unsigned bits = 1;
+
+        while ((std::size_t(1) << bits) < entries.size())
+          ++bits;
+
+        Query_table *nt;
+
+        while (!(nt = Query_table::make(entries, bits)))
+          ++bits;
+
+        Simple_atomic::release();
+
+        table = nt;
+      }
+
+  private:
+
+    Simple_atomic::T<const Query_table *> table;
+  };
+
+template <class C>
+struct Class_info_holder
+  {
+    static Class_info info;
+  };
+
+template <class C>
+Class_info Class_info_holder<C>::info;
+
+// Address of the class's information, which identifies the class.
+//
+using Class_id = Class_info *;
+
+template <class C>
+constexpr Class_id class_id() { return(&Class_info_holder<C>::info); }
+
+#ifdef IFACE_PROFILE
+
+// Number of calls through each vstructure, in an open addressing hash
+// table keyed by the vpointer.
+//
+struct Profile_entry
+  {
+    Simple_atomic::T<const void *> vptr;
+
+    Simple_atomic::T<unsigned long> count;
+  };
+
+const std::size_t Profile_size = 4096;
+
+inline Profile_entry * profile_table()
+  {
+    static Profile_entry t[Profile_size];
+
+    return(t);
+  }
+
+inline void profile_count(const void *vptr)
+  {
+    Profile_entry *t = profile_table();
+
+    std::size_t i =
+      std::size_t((std::uint64_t(std::uintptr_t(vptr)) *
+                   0x9e3779b97f4a7c15ULL) >> 52);
+
+    for (std::size_t n = 0; n < Profile_size;
+         ++n, i = (i + 1) bitand (Profile_size - 1))
+      {
+        const void *v = t[i].vptr;
+
+        if (!v)
+          {
+            // Claim empty slot.  If another thread claims it first, v
+            // is set to its vpointer.
+            //
+            while (!t[i].vptr.compare_exchange(v, vptr) and !v)
+              ;
+
+            if (!v)
+              v = vptr;
+          }
+
+        if (v == vptr)
+          {
+            t[i].count.fetch_add(1);
+
+            return;
+          }
+      }
+
+    // Table full, call not counted.
+  }
+
+// Names of the interface and class for vstructures of enabled classes.
+//
+struct Profile_name
+  {
+    const void *vptr;
+
+    const char *iface;
+
+    const char *cls;
+  };
+
+inline std::vector<Profile_name> & profile_names()
+  {
+    static std::vector<Profile_name> v;
+
+    return(v);
+  }
+
+inline void profile_name(const void *vptr, const char *iface, const char *cls)
+  {
+    Multi_spin_lock<>::Sentry sentry(query_lock());
+
+    profile_names().push_back(Profile_name{ vptr, iface, cls });
+  }
+
+inline std::string demangle(const char *name)
+  {
+    #ifdef __GNUC__
+
+    int status;
+
+    char *d = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+
+    if (d)
+      {
+        std::string result(d);
+
+        std::free(d);
+
+        return(result);
+      }
+
+    #endif
+
+    return(name);
+  }
+
+#endif // IFACE_PROFILE
+
+// The static member "done" is instantiated (and so initialized) if it is
+// used, which IFACE_ENABLE does.
+//
+template <class Iface, class Cls>
+struct Query_registrar
+  {
+    static const bool done;
+  };
+
+template <class Iface, class Cls>
+const bool Query_registrar<Iface, Cls>::done =
+  (class_id<Cls>()->insert(id<Iface>(), Enable<Iface, Cls>::vptr()),
+   #ifdef IFACE_PROFILE
+   profile_name(Enable<Iface, Cls>::vptr(), typeid(Iface).name(),
+                typeid(Cls).name()),
+   #endif
+   true);
+
+template <class T>
+using Remove_cv = typename std::remove_cv<T>::type;
+
+// Descriptor (in a vstructure) of a data member of type T.
+//
+template <class T>
+struct Field
+  {
+    // Offset of the data member in the class.
+    //
+    std::size_t offset;
+  };
+
+// To has the same CV qualifiers as From.
+
+template <class From, class To>
+struct Copy_cv { using Type = To; };
+
+template <class From, class To>
+struct Copy_cv<const From, To> { using Type = const To; };
+
+template <class From, class To>
+struct Copy_cv<volatile From, To> { using Type = volatile To; };
+
+template <class From, class To>
+struct Copy_cv<const volatile From, To> { using Type = const volatile To; };
+
+// Pointer to a data member, of the object pointed to by this_.  V is void,
+// with the CV qualifier of the interface.
+//
+template <class T, class V>
+inline typename Copy_cv<V, T>::Type * field_ptr(V *this_, Field<T> f)
+  {
+    return(
+      reinterpret_cast<typename Copy_cv<V, T>::Type *>(
+        static_cast<typename Copy_cv<V, char>::Type *>(this_) + f.offset));
+  }
+
+// Key for lookup table from interface type / class type combo to a pointer
+// to a pointer to the vstructure for the class for that interface.
+//
+class Convert_key
+  {
+  private:
+
+    // ID of interface resulting from interface conversion.
+    const Iface_id dest_iface_id;
+
+    // ID of class of instance interfaced to.
+    const Class_id class_id;
+
+  public:
+
+    Convert_key(Iface_id i, Class_id c) : dest_iface_id(i), class_id(c) { }
+
+    // Mix all the bits of both IDs, so that the low bits of the result can
+    // be used as a table index.
+    //
+    std::size_t hash() const
+      {
+        std::uint64_t h =
+          (std::uint64_t(std::uintptr_t(dest_iface_id)) *
+           0x9e3779b97f4a7c15ULL) ^
+          std::uint64_t(std::uintptr_t(class_id));
+
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+
+        return(std::size_t(h));
+      }
+
+    friend bool operator == (Convert_key a, Convert_key b)
+      { return((a.dest_iface_id == b.dest_iface_id) and
+               (a.class_id == b.class_id)); }
+  };
+
+// Concurrent hash table (open addressing, linear probing) from conversion
+// key to destination vstructure.  Lookup is wait-free.  Inserts are
+// serialized by a spin lock.  Entries are never removed.  When the table
+// gets half full, it is replaced by one twice as large.  The old table is
+// not freed, since readers may still be using it.  (So the total memory
+// used is less than twice the size of the final table.)
+//
+class Convert_table
+  {
+  public:
+
+    Convert_table() : table(new_table(Initial_size)), count(0) { }
+
+    Convert_table(const Convert_table &) = delete;
+    Convert_table & operator = (const Convert_table &) = delete;
+
+    // Returns null if the key is not in the table.
+    //
+    const void * find(Convert_key k) const
+      {
+        const Table *t = table;
+
+        Simple_atomic::acquire();
+
+        for (std::size_t i = k.hash() bitand t->mask; ;
+             i = (i + 1) bitand t->mask)
+          {
+            const Node *n = t->slot[i];
+
+            if (!n)
+              return(nullptr);
+
+            Simple_atomic::acquire();
+
+            if (n->key == k)
+              return(n->vptr);
+          }
+      }
+
+    // If the key is already in the table, returns the vstructure it maps
+    // to.  Otherwise, adds the key mapping to vptr, and returns vptr.
+    //
+    const void * insert(Convert_key k, const void *vptr)
+      {
+        Multi_spin_lock<>::Sentry sentry(lock);
+
+        const void *existing = find(k);
+
+        if (existing)
+          return(existing);
+
+        const Table *t = table;
+
+        if (2 * (count + 1) > (t->mask + 1))
+          {
+            // Grow.
+            //
+            Table *nt = new_table(2 * (t->mask + 1));
+
+            for (std::size_t i = 0; i <= t->mask; ++i)
+              {
+                const Node *n = t->slot[i];
+
+                if (n)
+                  nt->slot[free_slot(nt, n->key)] = n;
+              }
+
+            Simple_atomic::release();
+
+            table = nt;
+
+            t = nt;
+          }
+
+        const Node *n = new Node{k, vptr};
+
+        Simple_atomic::release();
+
+        t->slot[free_slot(t, k)] = n;
+
+        count = count + 1;
+
+        return(vptr);
+      }
+
+    std::size_t size() const { return(count); }
+
+  private:
+
+    static const std::size_t Initial_size = 16;
+
+    struct Node
+      {
+        const Convert_key key;
+
+        const void * const vptr;
+      };
+
+    struct Table
+      {
+        // Number of slots minus one (number of slots is a power of 2).
+        //
+        std::size_t mask;
+
+        Simple_atomic::T<const Node *> *slot;
+      };
+
+    static Table * new_table(std::size_t size)
+      {
+        Table *t = new Table;
+
+        t->mask = size - 1;
+
+        // Slots are initialized to null.
+        //
+        t->slot = new Simple_atomic::T<const Node *>[size];
+
+        return(t);
+      }
+
+    static std::size_t free_slot(const Table *t, Convert_key k)
+      {
+        std::size_t i = k.hash() bitand t->mask;
+
+        while (t->slot[i]())
+          i = (i + 1) bitand t->mask;
+
+        return(i);
+      }
+
+    Simple_atomic::T<const Table *> table;
+
+    Simple_atomic::T<std::size_t> count;
+
+    Multi_spin_lock<> lock;
+  };
+
+// Table to get vpointer for result (destination) interface in interface
+// conversion.
+//
+inline Convert_table & convert_map()
+  {
+    static Convert_table m;
+
+    return(m);
+  }
+
+// Vstructure, followed by pointers to the vstructures (for the same class)
+// for each static conversion from the interface.
+//
+template <class Iface, class List = typename Static_conversions<Iface>::List>
+struct Vstruct_with_conv;
+
+template <class Iface, class ... Dests>
+struct Vstruct_with_conv<Iface, Type_list<Dests...> >
+  {
+    typename Iface::Vstruct v;
+
+    const void *conv[sizeof...(Dests)];
+  };
+
+template <class Iface>
+struct Vstruct_with_conv<Iface, Type_list<> >
+  {
+    typename Iface::Vstruct v;
+  };
+
+// "value" is one plus the index of Cls in the list given to IFACE_SEAL for
+// Iface, or zero if it's not in the list.
+//
+template <class Iface, class Cls>
+struct Seal_index
+  {
+    static const unsigned value =
+      unsigned(Index_of<Cls, typename Sealed<Iface>::List>::value + 1);
+  };
+
+// Call through an instance of a sealed interface.  Fn is the type for the
+// member function generated by IFACE_SEAL.  Compares the seal index with
+// that of each class in turn (which the compiler can turn into a jump
+// table).
+//
+template <class Fn, class List = typename Sealed<typename Fn::Iface>::List,
+          unsigned Idx = 1>
+struct Seal_dispatch;
+
+template <class Fn, unsigned Idx>
+struct Seal_dispatch<Fn, Type_list<>, Idx>
+  {
+    template <class Iface, class ... Args>
+    static typename Fn::Ret call(const Iface &i, Args && ... args)
+      { return(Fn::indirect(i.vptr, i.this_, std::forward<Args>(args)...)); }
+  };
+
+template <class Fn, class Cls, class ... Rest, unsigned Idx>
+struct Seal_dispatch<Fn, Type_list<Cls, Rest...>, Idx>
+  {
+    template <class Iface, class ... Args>
+    static typename Fn::Ret call(const Iface &i, Args && ... args)
+      {
+        if (i.vptr->seal_index == Idx)
+          return(
+            Fn::template direct<Cls>(i.this_, std::forward<Args>(args)...));
+
+        return(
+          Seal_dispatch<Fn, Type_list<Rest...>, Idx + 1>::call(
+            i, std::forward<Args>(args)...));
+      }
+  };
+
+// Holds a constant-initialized vstructure, made by Maker::make().  Maker
+// also gives the interface and class the vstructure is for.  The holder is
+// a template instance, so (with GCC, for ELF) the vstructure is in its own
+// section, named with the mangled name of the holder.  When linking with
+// --sort-section=name, the vstructures are contiguous, with those marked
+// with IFACE_HOT first.
+//
+template <bool Cold, class Maker>
+struct Vstruct_holder
+  {
+    static constexpr typename Maker::Type v = Maker::make();
+  };
+
+template <bool Cold, class Maker>
+constexpr typename Maker::Type Vstruct_holder<Cold, Maker>::v;
+
+template <class Maker>
+using Vstruct_of =
+  Vstruct_holder<
+    !Hot<typename Maker::Iface, Remove_cv<typename Maker::Cls> >::value,
+    Maker>;
+
+// Vstructure (with static conversions) for Base::Iface and Base::Cls,
+// with the base part made by Base::base().  The vstructures for static
+// conversions are made the same way, so they are followed by the pointers
+// for their own static conversions, recursively.
+//
+template <class Base,
+          class List = typename Static_conversions<typename Base::Iface>::List>
+struct Vstruct_maker;
+
+// Base for the vstructure of an enabled class.
+//
+template <class Iface_, class Cls_>
+struct Enabled_base
+  {
+    using Iface = Iface_;
+
+    using Cls = Cls_;
+
+    static constexpr typename Iface::Vstruct base()
+      { return(Enable<Iface, Cls>::base()); }
+  };
+
+// Base for the vstructure of a static conversion from the vstructure
+// whose base is Src_base.
+//
+template <class Dest_iface, class Src_base>
+struct Class_conv
+  {
+    using Iface = Dest_iface;
+
+    using Cls = typename Src_base::Cls;
+
+    static constexpr typename Iface::Vstruct base()
+      {
+        return(
+          Iface::vstruct_from(
+            Src_base::base(), Seal_index<Iface, Cls>::value));
+      }
+  };
+
+template <class Base, class ... Dests>
+struct Vstruct_maker<Base, Type_list<Dests...> >
+  {
+    using Iface = typename Base::Iface;
+
+    using Cls = typename Base::Cls;
+
+    using Type = Vstruct_with_conv<Iface>;
+
+    static constexpr Type make()
+      {
+        return(
+          Type{ Base::base(),
+                { &Vstruct_of<
+                     Vstruct_maker<Class_conv<Dests, Base> > >::v.v... } });
+      }
+  };
+
+template <class Base>
+struct Vstruct_maker<Base, Type_list<> >
+  {
+    using Iface = typename Base::Iface;
+
+    using Cls = typename Base::Cls;
+
+    using Type = Vstruct_with_conv<Iface>;
+
+    static constexpr Type make() { return(Type{ Base::base() }); }
+  };
+
+template <class Iface, class Cls>
+using Enabled_vstruct = Vstruct_maker<Enabled_base<Iface, Cls> >;
+
+// Arena for vstructures created at run time.  The vstructures are packed
+// into pages that are read-only, except while a vstructure is being
+// copied in.  (On systems without mmap(), vstructures are allocated on the
+// heap.)
+//
+class Vstruct_arena
+  {
+  public:
+
+    Vstruct_arena() : page(nullptr), used(0) { }
+
+    Vstruct_arena(const Vstruct_arena &) = delete;
+    Vstruct_arena & operator = (const Vstruct_arena &) = delete;
+
+    // Returns a read-only copy of the object (of the given size and
+    // alignment) at src.
+    //
+    const void * copy(const void *src, std::size_t size, std::size_t align)
+      {
+        #if IFACE_IMPL_HAVE_MMAP
+
+        Multi_spin_lock<>::Sentry sentry(lock);
+
+        std::size_t offset = (used + align - 1) bitand ~(align - 1);
+
+        if (!page or ((offset + size) > Page_size))
+          {
+            void *p =
+              size > Page_size ? MAP_FAILED :
+                mmap(nullptr, Page_size, PROT_READ,
+                     MAP_PRIVATE bitor MAP_ANONYMOUS, -1, 0);
+
+            if (p == MAP_FAILED)
+              return(heap_copy(src, size));
+
+            page = static_cast<unsigned char *>(p);
+
+            offset = 0;
+          }
+
+        if (mprotect(page, Page_size, PROT_READ bitor PROT_WRITE) != 0)
+          return(heap_copy(src, size));
+
+        std::memcpy(page + offset, src, size);
+
+        mprotect(page, Page_size, PROT_READ);
+
+        used = offset + size;
+
+        return(page + offset);
+
+        #else
+
+        static_cast<void>(align);
+
+        return(heap_copy(src, size));
+
+        #endif
+      }
+
+  private:
+
+    static const std::size_t Page_size = 64 * 1024;
+
+    // Page vstructures are currently being added to.
+    //
+    unsigned char *page;
+
+    // Bytes of the page used.
+    //
+    std::size_t used;
+
+    Multi_spin_lock<> lock;
+
+    static const void * heap_copy(const void *src, std::size_t size)
+      {
+        void *p = ::operator new(size);
+
+        std::memcpy(p, src, size);
+
+        return(p);
+      }
+  };
+
+inline Vstruct_arena & vstruct_arena()
+  {
+    static Vstruct_arena a;
+
+    return(a);
+  }
+
+template <class T>
+const T * arena_copy(const T &v)
+  {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "vstructure must be trivially copyable");
+
+    return(
+      static_cast<const T *>(vstruct_arena().copy(&v, sizeof(T), alignof(T))));
+  }
+
+template <class Dest_iface, class Src_vstruct>
+const typename Dest_iface::Vstruct * convert_vptr(const Src_vstruct *src_vptr);
+
+// Create a vstructure, with (recursively converted) static conversions.
+//
+template <class Iface, class List = typename Static_conversions<Iface>::List>
+struct New_vstruct;
+
+template <class Iface, class ... Dests>
+struct New_vstruct<Iface, Type_list<Dests...> >
+  {
+    static const typename Iface::Vstruct * make(
+      const typename Iface::Vstruct &base)
+      {
+        return(
+          &arena_copy(
+            Vstruct_with_conv<Iface>{
+              base, { convert_vptr<Dests>(&base)... } })->v);
+      }
+  };
+
+template <class Iface>
+struct New_vstruct<Iface, Type_list<> >
+  {
+    static const typename Iface::Vstruct * make(
+      const typename Iface::Vstruct &base)
+      { return(&arena_copy(Vstruct_with_conv<Iface>{ base })->v); }
+  };
+
+// Conversion at run time, using the table.  A destination vstructure is
+// created (and never freed) in the arena the first time the conversion is
+// done for a class.
+//
+template <class Dest_iface, class Src_vstruct>
+const typename Dest_iface::Vstruct * convert_vptr(const Src_vstruct *src_vptr)
+  {
+    using Vs = typename Dest_iface::Vstruct;
+
+    Convert_key k(id<Dest_iface>(), src_vptr->class_id);
+
+    const void *vp = convert_map().find(k);
+
+    if (vp)
+      return(static_cast<const Vs *>(vp));
+
+    // Create the vstructure without holding the table's lock, since
+    // creating it may require other conversions.  If another thread
+    // inserts one first, this one is leaked.
+    //
+    vp = New_vstruct<Dest_iface>::make(Dest_iface::vstruct_from(*src_vptr));
+
+    return(static_cast<const Vs *>(convert_map().insert(k, vp)));
+  }
+
+// Static conversion, a single load.
+//
+template <class Dest_iface, class Src_iface, int Static_idx>
+struct Convert_vptr
+  {
+    static const typename Dest_iface::Vstruct * get(
+      const typename Src_iface::Vstruct *src_vptr)
+      {
+        return(
+          static_cast<const typename Dest_iface::Vstruct *>(
+            reinterpret_cast<const Vstruct_with_conv<Src_iface> *>(
+              src_vptr)->conv[Static_idx]));
+      }
+  };
+
+// Conversion enabled by IFACE_CONVERSION.
+//
+template <class Dest_iface, class Src_iface>
+struct Convert_vptr<Dest_iface, Src_iface, -1>
+  {
+    static const typename Dest_iface::Vstruct * get(
+      const typename Src_iface::Vstruct *src_vptr)
+      { return(Convert<Dest_iface, Src_iface>::vptr(src_vptr)); }
+  };
+
+template <class T>
+using Decay = typename std::decay<T>::type;
+
+// Cache for IFACE_CONVERT_CACHED.  Each entry is a pointer to a destination
+// vstructure, which contains the class ID, so an entry is never seen half
+// updated.  Entries are replaced round robin.  Constant initialized.
+//
+template <class Dest_iface>
+class Convert_cache
+  {
+  public:
+
+    constexpr Convert_cache()
+      : entry{ {Simple_atomic::No_threads}, {Simple_atomic::No_threads},
+               {Simple_atomic::No_threads}, {Simple_atomic::No_threads} },
+        next(Simple_atomic::No_threads)
+      { }
+
+    template <class Src_iface>
+    Dest_iface convert(Src_iface src_if)
+      {
+        const Class_id c = src_if.vptr->class_id;
+
+        for (unsigned i = 0; i < Size; ++i)
+          {
+            const Vs *vp = entry[i];
+
+            if (vp)
+              {
+                Simple_atomic::acquire();
+
+                if (vp->class_id == c)
+                  return(Dest_iface(src_if.this_, vp));
+              }
+          }
+
+        Dest_iface d = iface_convert<Dest_iface>(src_if);
+
+        Simple_atomic::release();
+
+        entry[next.fetch_add(1) % Size] = d.vptr;
+
+        return(d);
+      }
+
+  private:
+
+    using Vs = typename Dest_iface::Vstruct;
+
+    static const unsigned Size = 4;
+
+    Simple_atomic::T<const Vs *> entry[Size];
+
+    // Index (modulo Size) of next entry to replace.
+    //
+    Simple_atomic::T<unsigned> next;
+  };
+
+} // end namespace Iface_impl
+
+#ifdef IFACE_PROFILE
+
+// Write, for each vstructure that calls have been made through (with
+// IFACE_CALL or IFACE_CALL_NP), in descending order of the number of calls,
+// an invocation of IFACE_HOT for the interface type and class, with the
+// number of calls in a comment.  The output can be edited down to the
+// hottest vstructures, and included (in a build without IFACE_PROFILE)
+// before the invocations of IFACE_ENABLE.  Vstructures for conversions are
+// only listed in comments.
+//
+inline void iface_profile_dump(std::ostream &os)
+  {
+    using namespace Iface_impl;
+
+    std::vector<std::pair<unsigned long, const void *> > counts;
+
+    for (std::size_t i = 0; i < Profile_size; ++i)
+      {
+        const void *vptr = profile_table()[i].vptr;
+
+        if (vptr)
+          counts.push_back(std::make_pair(profile_table()[i].count(), vptr));
+      }
+
+    std::sort(counts.begin(), counts.end());
+
+    Multi_spin_lock<>::Sentry sentry(query_lock());
+
+    for (auto c = counts.rbegin(); c != counts.rend(); ++c)
+      {
+        const Profile_name *n = nullptr;
+
+        for (const Profile_name &pn : profile_names())
+          if (pn.vptr == c->second)
+            n = &pn;
+
+        if (n)
+          os << "IFACE_HOT(" << demangle(n->iface) << ", "
+             << demangle(n->cls) << ") // " << c->first << " calls\n";
+        else
+          os << "// " << c->first << " calls through conversion vstructure "
+             << c->second << '\n';
+      }
+  }
+
+#endif // IFACE_PROFILE
 
 #endif // Include once.
 
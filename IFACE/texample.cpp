@@ -0,0 +1,178 @@
+/*
+Copyright (c) 2026 Walter William Karas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Example of use of the template-based interfaces in tiface.h.  (Compare
+// with example.cpp.)
+
+#include "tiface.h"
+#include "tiface.h" // test re-inclusion guard
+
+#include <iostream>
+
+// Identifiers for class instances in this example.
+enum Instance
+  {
+    I_z_a_1,
+    I_z_a_2,
+    I_z_b_1
+  };
+
+// Identifiers for class member functions in this example.
+enum Method
+  {
+    M_a_z_1,
+    M_b_z_1
+  };
+
+// Define the methods of interface Z.
+
+struct Who : Tiface_method<Instance()>
+  {
+    template <class C>
+    static constexpr auto mp() { return(&C::who); }
+  };
+
+struct Z1 : Tiface_method<Method(int *, int)>
+  {
+    template <class C>
+    static constexpr auto mp() { return(&C::z1); }
+  };
+
+struct Z2 : Tiface_method<void(void *)>
+  {
+    template <class C>
+    static constexpr auto mp() { return(&C::z2); }
+  };
+
+using Z = Tiface<Who, Z1, Z2>;
+
+// An interface to const objects can only use const member functions.
+//
+using Z_who = Tiface<Who>;
+
+// Exercise a Z interface.  I may be Z or a Tiface_direct with the same
+// methods.
+//
+template <class I>
+bool check(I iface, Instance who, Method z1_result)
+  {
+    if (tiface_call<Who>(iface) != who)
+      return(false);
+
+    if (tiface_call<Z1>(iface, nullptr, 0) != z1_result)
+      return(false);
+
+    tiface_call<Z2>(iface, nullptr);
+
+    return(true);
+  }
+
+class Z_A
+  {
+  private:
+
+    Instance who_;
+
+  public:
+
+    constexpr Z_A(Instance w) : who_(w) { }
+
+    Instance who() const { return(who_); }
+
+    Method z1(int *, int) { return(M_a_z_1); }
+
+    void z2(void *) { }
+  };
+
+class Z_B
+  {
+  private:
+
+    Instance who_;
+
+  public:
+
+    constexpr Z_B(Instance w) : who_(w) { }
+
+    Instance who() const { return(who_); }
+
+    Method z1(int *, int) { return(M_b_z_1); }
+
+    void z2(void *) { }
+
+    void not_in_any_iface(int) { }
+  };
+
+Z_A z_a_1(I_z_a_1);
+
+// Constant initialized, since the vtable is a constant.
+//
+constexpr Z z_a_1_if(z_a_1);
+
+int main()
+  {
+    bool failed = false;
+
+    Z_A z_a_2(I_z_a_2);
+    Z_B z_b_1(I_z_b_1);
+
+    // Calls through the vtable.
+    //
+    if (!check(z_a_1_if, I_z_a_1, M_a_z_1) or
+        !check(Z(z_a_2), I_z_a_2, M_a_z_1) or
+        !check(Z(z_b_1), I_z_b_1, M_b_z_1))
+      failed = true;
+
+    // Direct calls.
+    //
+    if (!check(Tiface_direct<Z_A, Who, Z1, Z2>(z_a_2), I_z_a_2, M_a_z_1) or
+        !check(Tiface_direct<Z_B, Who, Z1, Z2>(z_b_1), I_z_b_1, M_b_z_1))
+      failed = true;
+
+    // Conversion of direct to indirect interface.
+    //
+    {
+      Z z = Tiface_direct<Z_B, Who, Z1, Z2>(z_b_1);
+
+      if (!check(z, I_z_b_1, M_b_z_1))
+        failed = true;
+    }
+
+    // Interface to a const object.
+    //
+    {
+      const Z_B &cz = z_b_1;
+
+      if (tiface_call<Who>(Z_who(cz)) != I_z_b_1)
+        failed = true;
+    }
+
+    // The vtables for a class are shared.
+    //
+    if (Z(z_a_2).vptr != z_a_1_if.vptr)
+      failed = true;
+
+    // Same layout as interfaces in iface.h.
+    //
+    static_assert(sizeof(Z) == (2 * sizeof(void *)), "");
+
+    std::cout << (failed ? "FAILED\n" : "SUCCESS\n");
+
+    return(0);
+  }
@@ -0,0 +1,191 @@
+/*
+Copyright (c) 2026 Walter William Karas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*
+
+"Go-like" interfaces for C++, like those in iface.h, but defined with
+templates rather than macros.  Requires C++17.  See texample.cpp for example
+use.
+
+A member function of an interface is specified by a "method" type, derived
+from Tiface_method<SIG>, where SIG is the function type of the member
+function (without a CV qualifier).  The method type must have a static
+member function template mp() returning a pointer to the member function
+of a class C.  For example:
+
+struct Z1 : Tiface_method<int(int)>
+  {
+    template <class C>
+    static constexpr auto mp() { return(&C::z1); }
+  };
+
+An interface type is Tiface<METHODS...>.  Like the interfaces in iface.h, an
+instance is a pointer to the object interfaced to, and a pointer to a
+vtable of pointers to thunks that call the member functions.  The vtable for
+each class is constant initialized.  Any class with (non-overloaded)
+member functions matching the methods can be interfaced to, without
+needing to enable it.  If the object is const, only const member functions
+can be called through the interface.
+
+Tiface_direct<C, METHODS...> is an interface to an object of class C, known
+at compile time.  Calls through it are direct (not through the vtable), so
+they can be inlined.  It implicitly converts to Tiface<METHODS...>.
+Code that is generic over an interface type (a template parameter), and
+calls member functions with tiface_call(), makes indirect calls when
+instantiated for Tiface, and direct calls when instantiated for
+Tiface_direct.
+
+Unlike iface.h, there is no conversion between interface types.
+
+*/
+
+#ifndef TIFACE_20261018
+#define TIFACE_20261018
+
+#include <type_traits>
+#include <utility>
+
+template <class Sig>
+struct Tiface_method;
+
+template <class R, class ... Args>
+struct Tiface_method<R(Args...)>
+  {
+    using Sig = R(Args...);
+
+    // Type of pointer to thunk.
+    //
+    using Fp = R (*)(void *this_, Args ... args);
+  };
+
+template <class ... Methods>
+struct Tiface;
+
+template <class Cls, class ... Methods>
+struct Tiface_direct;
+
+namespace Tiface_impl
+{
+
+template <class Method, class Cls, class Sig = typename Method::Sig>
+struct Thunk;
+
+template <class Method, class Cls, class R, class ... Args>
+struct Thunk<Method, Cls, R(Args...)>
+  {
+    static R call(void *this_, Args ... args)
+      {
+        return(
+          (static_cast<Cls *>(this_)->*Method::template mp<Cls>())(
+            std::forward<Args>(args)...));
+      }
+  };
+
+// Slot in vtable for one method.
+//
+template <class Method>
+struct Slot
+  {
+    typename Method::Fp fp;
+  };
+
+template <class ... Methods>
+struct Vtable : Slot<Methods>...
+  {
+  };
+
+template <class Cls, class ... Methods>
+inline constexpr Vtable<Methods...> vtable_for =
+  { Slot<Methods>{ &Thunk<Methods, Cls>::call }... };
+
+template <class Method, class ... Methods>
+inline constexpr bool contains = (std::is_same_v<Method, Methods> or ...);
+
+// True if T is an interface type (so the constructor of Tiface for
+// interfacing to objects does not hide the copy constructor).
+//
+template <class T>
+struct Is_iface : std::false_type { };
+
+template <class ... Methods>
+struct Is_iface<Tiface<Methods...> > : std::true_type { };
+
+template <class Cls, class ... Methods>
+struct Is_iface<Tiface_direct<Cls, Methods...> > : std::true_type { };
+
+} // end namespace Tiface_impl
+
+template <class ... Methods>
+struct Tiface
+  {
+    /* Do not access the contents of this directly */
+
+    void * this_;
+
+    const Tiface_impl::Vtable<Methods...> * vptr;
+
+    template <
+      class Cls,
+      class = std::enable_if_t<
+        !Tiface_impl::Is_iface<std::remove_cv_t<Cls> >::value> >
+    constexpr Tiface(Cls &c)
+      : this_(const_cast<void *>(static_cast<const volatile void *>(&c))),
+        vptr(&Tiface_impl::vtable_for<Cls, Methods...>)
+      { }
+  };
+
+template <class Cls, class ... Methods>
+struct Tiface_direct
+  {
+    /* Do not access the contents of this directly */
+
+    Cls * this_;
+
+    constexpr Tiface_direct(Cls &c) : this_(&c) { }
+
+    constexpr operator Tiface<Methods...> () const
+      { return(Tiface<Methods...>(*this_)); }
+  };
+
+// Call the member function for Method through an interface instance.  The
+// variable arguments are the member function's actual arguments.
+
+template <class Method, class ... Methods, class ... Args>
+inline decltype(auto) tiface_call(Tiface<Methods...> i, Args && ... args)
+  {
+    static_assert(Tiface_impl::contains<Method, Methods...>,
+                  "method not in interface");
+
+    return(
+      static_cast<const Tiface_impl::Slot<Method> *>(i.vptr)->fp(
+        i.this_, std::forward<Args>(args)...));
+  }
+
+template <class Method, class Cls, class ... Methods, class ... Args>
+inline decltype(auto) tiface_call(
+  Tiface_direct<Cls, Methods...> i, Args && ... args)
+  {
+    static_assert(Tiface_impl::contains<Method, Methods...>,
+                  "method not in interface");
+
+    return(
+      (i.this_->*Method::template mp<Cls>())(std::forward<Args>(args)...));
+  }
+
+#endif // Include once.
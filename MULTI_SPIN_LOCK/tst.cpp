@@ -22,6 +22,9 @@ SOFTWARE.
 #include "multi_spin_lock.h"
 #include "multi_spin_lock.h" // test re-inclusion guard
 
+#include "cpu_topology.h"
+#include "perf_counters.h"
+
 #include <cstdlib>
 #include <iostream>
 #include <thread>
@@ -46,6 +49,11 @@ bool done;
 //
 std::vector<unsigned> thread_lock_count;
 
+// thread_cpu[i] is the CPU the thread with index i is pinned to.  Empty if
+// threads are not pinned.
+//
+std::vector<unsigned> thread_cpu;
+
 class Test_thread
   {
   public:
@@ -56,6 +64,10 @@ class Test_thread
         static unsigned trace_val = 1000;
         int random;
 
+        if (!thread_cpu.empty() and !Cpu_topology::pin(thread_cpu[index]))
+          std::cout << "pinning thread " << index << " to cpu "
+                    << thread_cpu[index] << " failed" << std::endl;
+
         while (!done)
           {
             {
@@ -107,36 +119,66 @@ unsigned Test_thread::count;
 
 int main(int n_arg, const char * const *arg)
   {
-    int num_threads, seed;
+    int num_threads, seed = 0;
+
+    Cpu_topology::Placement placement = Cpu_topology::None;
 
     if ((n_arg < 2) or ((num_threads = std::atoi(arg[1])) < 1) or
-        (n_arg > 3) or ((seed = std::atoi(arg[1])) < 0))
+        (n_arg > 4) or ((n_arg > 2) and ((seed = std::atoi(arg[2])) < 0)) or
+        ((n_arg > 3) and !Cpu_topology::parse(arg[3], placement)))
       {
         std::cerr << "requires one parameter: number of threads\n";
         std::cerr << "optional second parameter: random seed (positive)\n";
+        std::cerr << "optional third parameter: thread placement (none, smt,"
+                     " ccx, or socket)\n";
 
         std::exit(1);
       }
 
     std::srand(unsigned(seed));
 
+    thread_cpu =
+      Cpu_topology::cpus_for(placement, num_threads, Cpu_topology::read());
+
+    std::cout << "placement = " << Cpu_topology::name(placement)
+              << ", cpus =";
+
+    if (thread_cpu.empty())
+      std::cout << " any";
+
+    for (unsigned cpu : thread_cpu)
+      std::cout << ' ' << cpu;
+
+    std::cout << '\n';
+
     std::vector<std::thread> t;
 
     thread_lock_count.resize(num_threads);
 
-    for (int i = 0; i < num_threads; ++i)
-      t.emplace_back(Test_thread());
+    Perf_counters::Counters counters;
 
-    std::cout << "Hit enter to stop:" << std::endl;
+    Perf_counters::Values counts;
 
-    char dummy;
+    {
+      // Counting must start before the threads are created, for their
+      // counts to be included.
+      //
+      Perf_counters::Scope ps(counters, &counts);
 
-    std::cin.get(dummy);
+      for (int i = 0; i < num_threads; ++i)
+        t.emplace_back(Test_thread());
 
-    done = true;
+      std::cout << "Hit enter to stop:" << std::endl;
 
-    for (int i = 0; i < num_threads; ++i)
-      t[i].join();
+      char dummy;
+
+      std::cin.get(dummy);
+
+      done = true;
+
+      for (int i = 0; i < num_threads; ++i)
+        t[i].join();
+    }
 
     std::cout << "\nFinal retry high water = " << Spin_lock::retry_high_water()
               << "\n\n";
@@ -176,9 +218,17 @@ int main(int n_arg, const char * const *arg)
         ttl += thread_lock_count[i];
       }
 
-    std::cout << "lock counts: max = " << max << ", min = " << min 
+    std::cout << "placement " << Cpu_topology::name(placement)
+              << " lock counts: max = " << max << ", min = " << min 
               << ", average = " << ((ttl + (num_threads / 2)) / num_threads)
               << '\n';
 
+    std::cout << "hardware counts per lock (including sleeps and random"
+                 " delays):\n";
+    Perf_counters::print_heading(std::cout);
+    std::cout << '\n';
+    Perf_counters::print(std::cout, counts.per(ttl ? ttl : 1));
+    std::cout << '\n';
+
     return(0);
   }
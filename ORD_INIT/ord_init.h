@@ -68,11 +68,91 @@ Ord_init.  Traits must have a public member function cycle(uintptr_t)
 (any return value is ignored).  This is called when a cyclical initialization
 dependency of Ord_init objects is detected.
 
-This facility does not provide any guarantees as to the order that objects
-are destroyed in.
-
-For Ord_init to work properly, all the objects defined with it, and those
-that depend on them, must be constructed within the same execution thread.
+If Traits has a static const bool member Lazy with the value true, the
+Ord_init constructor does not initialize the object.  Instead, it is
+initialized by the first call to init(), b(), or conversion to B &.  So an
+object that is never used is never constructed.  After the object is
+initialized, the check in b() and conversion to B & is (with GCC) hinted to
+the compiler as the likely case.
+
+If Traits has a static const bool member Enable_profile with the value true
+(C++11 or later), the initialization of the object is profiled.  The
+wall time of its constructor is recorded, inclusive of, and exclusive of,
+the time to initialize other profiled objects nested within it (by calls
+to init() in the constructor).  Only nested profiled objects are
+subtracted for the exclusive time, but they are subtracted even if nested
+within objects whose Traits do not enable profiling.  The rest of the time
+to initialize those objects is included in the exclusive time.  Each call
+to init() for a profiled object, while another profiled object is being
+initialized in the same thread, is recorded as a dependency edge (to it
+from the innermost such object).
+Calling ord_init_profile_dump() (typically at the start of main(), after
+static initialization) writes a timeline in Chrome trace event JSON format
+(which can be loaded into chrome://tracing or Perfetto), and the dependency
+graph in Graphviz DOT format.
+
+The B object held by an Ord_init<B> object is destroyed like a static
+object defined at block scope.  When its initialization completes, a
+function to destroy it is registered with std::atexit().  Static
+destructors and atexit functions are called in the reverse of the order
+of construction and registration.  So the B object is destroyed before the
+objects it depends on, and after any static object whose construction
+completed after its initialization (and so may use it in its destructor).
+If the B object is initialized before the constructor of its (static)
+Ord_init object is called, the Ord_init destructor leaves it to be
+destroyed by the atexit function.  Otherwise, the Ord_init destructor
+destroys it (if it was not already destroyed), so the B object held by an
+Ord_init object with automatic storage duration is destroyed when that
+goes out of scope.  After the B object is destroyed, init() does not
+construct it again.  If Traits has a static const bool member Fast_exit
+with the value true, the B object is for the lifetime of the process (for
+example, a cache or pool whose destructor only frees memory), and its
+destructor is never called.
+
+With C++98 or C++03, for Ord_init to work properly, all the objects defined
+with it, and those that depend on them, must be constructed within the same
+execution thread.  With C++11 or later, init() is thread-safe (this needs
+SIMPLE_ATOMIC in the include path).  Once the object is initialized, init()
+is just a load and an acquire fence.  If another thread is initializing the
+object, init() waits (spinning briefly, then blocking) until it is done.  If
+the constructor of T throws an exception, the object remains
+uninitialized, so a later call to init() will try again.  Cycles are
+detected for each thread separately.  (A cycle of dependencies in
+constructors running in different threads is not detected, and deadlocks.)
+
+Objects can also be initialized in parallel (C++11 or later).  An Ord_init
+object can instead be constructed with a list of the Ord_init objects it
+depends on:
+
+Ord_init<B> b(ord_init_after(c, d));
+
+Then b is not initialized by its constructor.  It is registered, with its
+dependencies, and initialized by a later call (typically at the start of
+main()) to:
+
+ord_init_parallel(num_threads);
+
+This initializes all the registered objects that are not yet initialized,
+using num_threads threads (including the calling thread).  Each object is
+initialized after the objects it depends on, and objects that do not depend
+on each other are initialized concurrently.  If b.init() is called after
+b's constructor but before ord_init_parallel(), b's dependencies are
+initialized first, then b, in the calling thread.  But if b.init() is called
+before b's constructor (for example, by the constructor of another object
+in a different compilation unit, during static initialization), b's
+declared dependencies are not yet known, so b is initialized without them.
+When b's constructor is called, if any of its dependencies are not yet
+initialized, Traits::unordered_init(uintptr_t) is called, or, if Traits
+does not have that member function, Traits::cycle(uintptr_t).  (So the
+constructor of a class like B, that may be initialized early, should still
+call init() for each of its dependencies.)  If the declared dependencies
+have a cycle, Traits::cycle() is called (in the thread calling
+ord_init_parallel()) for an object in the cycle, after all the objects not
+in or depending on the cycle are initialized.  If a constructor throws an
+exception, no more objects are initialized, and ord_init_parallel()
+rethrows it.  An Ord_init object constructed with ord_init_after() must
+have static storage duration.  Its dependencies are kept in a table apart
+from it, so other Ord_init objects are no bigger for it.
 
 */
 
@@ -92,8 +172,584 @@ that depend on them, must be constructed within the same execution thread.
 
 #endif
 
+#include <cstdlib>
+#include <vector>
+
+#if __cplusplus >= 201100
+
+#include <chrono>
+#include <condition_variable>
+#include <iomanip>
+#include <exception>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <typeinfo>
+#include <unordered_map>
+#include <utility>
+
+#ifdef __GNUC__
+#include <cxxabi.h>
+#endif
+
+#endif
+
 #include "ios_flag_save.h"
 
+#if __cplusplus >= 201100
+
+#include "simple_atomic.h"
+
+#endif
+
+namespace Ord_init_impl
+{
+
+// An object that another depends on.  Only the address of its Ord_init
+// object and functions are used, because the dependency may be used
+// (during static initialization) before its constructor is called.
+//
+struct Dep
+  {
+    void *obj;
+
+    // Initialize the object.
+    //
+    void (*init)(void *obj);
+
+    bool (*done)(void *obj);
+  };
+
+#if __cplusplus >= 201100
+
+// An object registered for initialization by ord_init_parallel().
+//
+struct Registered
+  {
+    Dep self;
+
+    // Call Traits::cycle() for the object.
+    //
+    void (*cycle)(void *obj);
+
+    // Objects this one is declared to depend on.
+    //
+    std::vector<Dep> deps;
+  };
+
+inline std::mutex & registry_mutex()
+  {
+    static std::mutex m;
+
+    return(m);
+  }
+
+// Registered objects, by address of their Ord_init objects.  Kept apart
+// from the Ord_init objects, so only registered objects pay for it.  Never
+// destroyed, since objects may be initialized during exit.
+//
+inline std::unordered_map<const void *, Registered> & registry()
+  {
+    static std::unordered_map<const void *, Registered> &r =
+      *new std::unordered_map<const void *, Registered>;
+
+    return(r);
+  }
+
+inline void add_registered(const Registered &r)
+  {
+    std::lock_guard<std::mutex> lock(registry_mutex());
+
+    registry()[r.self.obj] = r;
+  }
+
+// Initialize the objects obj is declared to depend on, if it is registered.
+//
+inline void init_deps(const void *obj)
+  {
+    const std::vector<Dep> *deps;
+
+    {
+      std::lock_guard<std::mutex> lock(registry_mutex());
+
+      auto r = registry().find(obj);
+
+      if (r == registry().end())
+        return;
+
+      // Elements of the map are never moved or removed.
+      //
+      deps = &r->second.deps;
+    }
+
+    for (const Dep &d : *deps)
+      d.init(d.obj);
+  }
+
+#endif
+
+// Initialized object, to be destroyed at exit.
+//
+struct Completed
+  {
+    // Null if the object was already destroyed by its Ord_init destructor.
+    //
+    void *obj;
+
+    void (*destroy)(void *obj);
+
+    // True if the object was initialized before the constructor of its
+    // (static) Ord_init object was called.  Then the Ord_init destructor
+    // is called before the object must be destroyed, so it leaves the
+    // object to be destroyed by the exit function.
+    //
+    bool early;
+  };
+
+// Initialized objects, in the order their initialization completed in.
+// There is one exit function (registered with std::atexit()) for each
+// entry.
+//
+inline std::vector<Completed> & completed()
+  {
+    static std::vector<Completed> v;
+
+    return(v);
+  }
+
+#if __cplusplus >= 201100
+
+inline std::mutex & completed_mutex()
+  {
+    static std::mutex m;
+
+    return(m);
+  }
+
+#endif
+
+class Completed_lock
+  {
+  public:
+
+    #if __cplusplus >= 201100
+
+    Completed_lock() : lock(completed_mutex()) { }
+
+  private:
+
+    std::lock_guard<std::mutex> lock;
+
+    #else
+
+    // No threads.
+    //
+    Completed_lock() { }
+
+    ~Completed_lock() { }
+
+    #endif
+  };
+
+// Exit function.  Static destructors and exit functions are called in the
+// reverse of the order of construction and registration, so this destroys
+// the most recently initialized object not yet destroyed.  (The lock is
+// not held while the object is destroyed, in case its destructor uses
+// other Ord_init objects.)
+//
+inline void destroy_last()
+  {
+    Completed c;
+
+    {
+      Completed_lock lock;
+
+      c = completed().back();
+
+      completed().pop_back();
+    }
+
+    if (c.obj)
+      c.destroy(c.obj);
+  }
+
+// Called when the initialization of an object completes.  Like the
+// destructor of a block-scope static object, the object is destroyed by a
+// function registered with std::atexit() at this point.  (So it is
+// destroyed after static objects whose construction completes later.)
+//
+inline void push_completed(void *obj, void (*destroy)(void *))
+  {
+    Completed_lock lock;
+
+    Completed c = { obj, destroy, false };
+
+    completed().push_back(c);
+
+    // If this fails, the object is destroyed by its Ord_init destructor.
+    //
+    if (std::atexit(&destroy_last) != 0)
+      completed().pop_back();
+  }
+
+// Find the entry for obj, if it has one.
+//
+inline Completed * find_completed(void *obj)
+  {
+    // Usually the entry is near the end.
+    //
+    for (std::size_t i = completed().size(); i > 0; --i)
+      if (completed()[i - 1].obj == obj)
+        return(&completed()[i - 1]);
+
+    return(0);
+  }
+
+// Called by the constructor of a static Ord_init object if its object was
+// initialized earlier, so the Ord_init destructor leaves the object to be
+// destroyed by the exit function.
+//
+inline void keep_for_exit(void *obj)
+  {
+    Completed_lock lock;
+
+    Completed *c = find_completed(obj);
+
+    if (c)
+      c->early = true;
+  }
+
+// Called by the Ord_init destructor of an initialized object.  Returns
+// true if the destructor must destroy the object.  If so, the exit function
+// for the object will do nothing.
+//
+inline bool unlink_completed(void *obj)
+  {
+    Completed_lock lock;
+
+    Completed *c = find_completed(obj);
+
+    if (!c)
+      return(true);
+
+    if (c->early)
+      return(false);
+
+    c->obj = 0;
+
+    return(true);
+  }
+
+// Defines a class template, named CLASS, whose static member "value" is the
+// value of the static const bool member MEMBER of its parameter Traits, or
+// false if Traits does not define it.
+//
+#define ORD_INIT_IMPL_TRAITS_FLAG(CLASS, MEMBER) \
+ \
+template <class Traits> \
+class CLASS \
+  { \
+  private: \
+ \
+    template <bool> \
+    struct Tag { }; \
+ \
+    typedef char Yes; \
+ \
+    struct No { char c[2]; }; \
+ \
+    template <class Tr> \
+    static Yes test(Tag<Tr::MEMBER> *); \
+ \
+    template <class Tr> \
+    static No test(...); \
+ \
+    template <class Tr, bool Has> \
+    struct Get { static const bool value = false; }; \
+ \
+    template <class Tr> \
+    struct Get<Tr, true> { static const bool value = Tr::MEMBER; }; \
+ \
+  public: \
+ \
+    static const bool value = \
+      Get<Traits, sizeof(test<Traits>(0)) == sizeof(Yes)>::value; \
+  };
+
+ORD_INIT_IMPL_TRAITS_FLAG(Is_lazy, Lazy)
+
+ORD_INIT_IMPL_TRAITS_FLAG(Is_fast_exit, Fast_exit)
+
+#if __cplusplus >= 201100
+
+ORD_INIT_IMPL_TRAITS_FLAG(Is_profiled, Enable_profile)
+
+#endif
+
+inline bool likely(bool b)
+  {
+    #ifdef __GNUC__
+
+    return(__builtin_expect(b, true));
+
+    #else
+
+    return(b);
+
+    #endif
+  }
+
+// List of the objects an Ord_init object depends on.
+//
+struct Deps
+  {
+    std::vector<Dep> deps;
+  };
+
+#if __cplusplus >= 201100
+
+// Entry in the stack, for the calling thread, of objects being initialized.
+//
+class Frame
+  {
+  public:
+
+    Frame(const void *obj_, bool profiled_)
+      : obj(obj_), profiled(profiled_), prev(top()), nested_ns(0)
+      { top() = this; }
+
+    ~Frame() { top() = prev; }
+
+    // Innermost profiled object being initialized by the calling thread,
+    // starting from frame f, or null.
+    //
+    static Frame * profiled_from(Frame *f)
+      {
+        while (f and !f->profiled)
+          f = f->prev;
+
+        return(f);
+      }
+
+    static Frame * innermost_profiled() { return(profiled_from(top())); }
+
+    static bool in_progress(const void *obj_)
+      {
+        for (const Frame *f = top(); f; f = f->prev)
+          if (f->obj == obj_)
+            return(true);
+
+        return(false);
+      }
+
+    const void * const obj;
+
+    // True if the initialization of the object is profiled.
+    //
+    const bool profiled;
+
+    Frame * const prev;
+
+    // Time (in nanoseconds) spent initializing profiled objects nested in
+    // this one.
+    //
+    long long nested_ns;
+
+  private:
+
+    static Frame * & top()
+      {
+        static thread_local Frame *t = nullptr;
+
+        return(t);
+      }
+  };
+
+inline std::mutex & wait_mutex()
+  {
+    static std::mutex m;
+
+    return(m);
+  }
+
+inline std::condition_variable & wait_cv()
+  {
+    static std::condition_variable cv;
+
+    return(cv);
+  }
+
+// Wait until done() returns true.  Most initializations are short, so
+// spin (yielding the processor) for a while before blocking.
+//
+template <class Done>
+void wait(Done done)
+  {
+    const unsigned Spin_limit = 100;
+
+    for (unsigned i = 0; i < Spin_limit; ++i)
+      {
+        if (done())
+          return;
+
+        std::this_thread::yield();
+      }
+
+    std::unique_lock<std::mutex> lock(wait_mutex());
+
+    wait_cv().wait(lock, done);
+  }
+
+// Call Traits::unordered_init() if Traits has it, otherwise Traits::cycle().
+//
+template <class Traits>
+auto unordered_init(Traits &t, std::uintptr_t addr, int)
+  -> decltype(t.unordered_init(addr), void())
+  { t.unordered_init(addr); }
+
+template <class Traits>
+void unordered_init(Traits &t, std::uintptr_t addr, long)
+  { t.cycle(addr); }
+
+// Wake waiting threads, after the condition they are waiting for is
+// changed.  (Locking the mutex makes sure a thread that checked the
+// condition before the change is waiting before being notified.)
+//
+inline void wake()
+  {
+    {
+      std::lock_guard<std::mutex> lock(wait_mutex());
+    }
+
+    wait_cv().notify_all();
+  }
+
+typedef std::chrono::steady_clock Clock;
+
+// Initialization of a profiled object.
+//
+struct Profile_record
+  {
+    const void *obj;
+
+    // Mangled name of the type of the object.
+    //
+    const char *type_name;
+
+    std::thread::id thread;
+
+    Clock::time_point start;
+
+    long long inclusive_ns, exclusive_ns;
+  };
+
+struct Profile
+  {
+    std::mutex mtx;
+
+    std::vector<Profile_record> records;
+
+    // Dependency edges (depending object, object depended on).
+    //
+    std::set<std::pair<const void *, const void *> > edges;
+  };
+
+inline Profile & profile()
+  {
+    static Profile p;
+
+    return(p);
+  }
+
+// Record an edge to (profiled) obj, from the innermost profiled object (if
+// any) the calling thread is initializing.  (Objects that are not profiled
+// in between are skipped.)
+//
+inline void profile_edge(const void *obj)
+  {
+    const Frame *f = Frame::innermost_profiled();
+
+    if (f and (f->obj != obj))
+      {
+        std::lock_guard<std::mutex> lock(profile().mtx);
+
+        profile().edges.insert(std::make_pair(f->obj, obj));
+      }
+  }
+
+// Record the initialization of the object in the innermost frame, that
+// started at "start".
+//
+inline void profile_init(
+  Frame &frame, const char *type_name, Clock::time_point start)
+  {
+    long long inclusive_ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+        Clock::now() - start).count();
+
+    // Subtract from the exclusive time of the innermost enclosing profiled
+    // object, even if objects that are not profiled are in between.
+    //
+    Frame *enclosing = Frame::profiled_from(frame.prev);
+
+    if (enclosing)
+      enclosing->nested_ns += inclusive_ns;
+
+    Profile_record r;
+
+    r.obj = frame.obj;
+    r.type_name = type_name;
+    r.thread = std::this_thread::get_id();
+    r.start = start;
+    r.inclusive_ns = inclusive_ns;
+    r.exclusive_ns = inclusive_ns - frame.nested_ns;
+
+    std::lock_guard<std::mutex> lock(profile().mtx);
+
+    profile().records.push_back(r);
+  }
+
+inline std::string demangle(const char *name)
+  {
+    #ifdef __GNUC__
+
+    int status;
+
+    char *d = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+
+    if (d)
+      {
+        std::string result(d);
+
+        std::free(d);
+
+        return(result);
+      }
+
+    #endif
+
+    return(name);
+  }
+
+// Name of object for profile output.  Quotes and backslashes are replaced,
+// so the name can be used in JSON and DOT strings.
+//
+inline std::string profile_name(const Profile_record &r)
+  {
+    std::string n = demangle(r.type_name);
+
+    for (char &c : n)
+      if ((c == '"') or (c == '\\'))
+        c = '_';
+
+    return(n);
+  }
+
+#endif
+
+} // end namespace Ord_init_impl
+
 struct Ord_init_default_traits
   {
     #if __cplusplus < 201100
@@ -119,6 +775,31 @@ struct Ord_init_default_traits
 
     IOS_FLAG_SAVE(Ifs)
 
+    #if __cplusplus >= 201100
+
+    class Ord_init_unordered_exception : public std::exception
+      {
+      public:
+
+        virtual const char * what() const noexcept
+          { return("Ord_init object initialized before its dependencies"); }
+      };
+
+    static void unordered_init(uintptr_t addr)
+      {
+        {
+          Ifs sentry(std::cerr);
+
+          std::cerr
+            << "Object at address 0x" << std::hex << addr
+            << " initialized before its declared dependencies\n";
+        }
+
+        throw Ord_init_unordered_exception();
+      }
+
+    #endif
+
     static void cycle(uintptr_t addr)
       {
         {
@@ -138,7 +819,7 @@ class Ord_init
   {
   private:
 
-    enum Status { Pre_init = 0, Init_in_progress, Init_done };
+    enum Status { Pre_init = 0, Init_in_progress, Init_done, Destroyed };
 
     // It's important that this member be initialized to zero
     // before any constructors are called.
@@ -160,11 +841,113 @@ class Ord_init
 
     #endif
 
+    #if __cplusplus >= 201100
+
+    Simple_atomic::Ref<Status> atomic_status()
+      { return(Simple_atomic::Ref<Status>(status)); }
+
+    void init_slow()
+      {
+        for ( ; ; )
+          {
+            Status s = Pre_init;
+
+            while (!atomic_status().compare_exchange(s, Init_in_progress))
+              if (s != Pre_init)
+                break;
+
+            if (s == Pre_init)
+              {
+                // This thread claimed the initialization.
+
+                Ord_init_impl::Frame frame(
+                  this, Ord_init_impl::Is_profiled<Traits>::value);
+
+                Ord_init_impl::Clock::time_point start;
+
+                if (Ord_init_impl::Is_profiled<Traits>::value)
+                  start = Ord_init_impl::Clock::now();
+
+                try
+                  {
+                    Ord_init_impl::init_deps(this);
+
+                    new(raw) T;
+                  }
+                catch (...)
+                  {
+                    atomic_status() = Pre_init;
+
+                    Ord_init_impl::wake();
+
+                    throw;
+                  }
+
+                if (Ord_init_impl::Is_profiled<Traits>::value)
+                  Ord_init_impl::profile_init(frame, typeid(T).name(), start);
+
+                if (!Ord_init_impl::Is_fast_exit<Traits>::value)
+                  Ord_init_impl::push_completed(this, &destroy_of);
+
+                Simple_atomic::release();
+
+                atomic_status() = Init_done;
+
+                Ord_init_impl::wake();
+
+                return;
+              }
+
+            if (s == Init_done)
+              {
+                Simple_atomic::acquire();
+
+                return;
+              }
+
+            // Not constructed again after it is destroyed.
+            //
+            if (s == Destroyed)
+              return;
+
+            if (Ord_init_impl::Frame::in_progress(this))
+              {
+                Traits().cycle(reinterpret_cast<uintptr_t>(this));
+
+                return;
+              }
+
+            // Wait for the initializing thread to finish (or fail).
+            //
+            Ord_init_impl::wait(
+              [this]() { return(atomic_status() != Init_in_progress); });
+          }
+      }
+
+    #endif
+
   public:
 
     void init()
       {
-        if (status == Init_done)
+        #if __cplusplus >= 201100
+
+        if (Ord_init_impl::Is_profiled<Traits>::value)
+          Ord_init_impl::profile_edge(this);
+
+        if (Ord_init_impl::likely(atomic_status() == Init_done))
+          {
+            Simple_atomic::acquire();
+
+            return;
+          }
+
+        init_slow();
+
+        #else
+
+        if (Ord_init_impl::likely(status == Init_done) or
+            (status == Destroyed))
           return;
 
         if (status == Init_in_progress)
@@ -174,21 +957,126 @@ class Ord_init
 
         new(raw) T;
 
+        if (!Ord_init_impl::Is_fast_exit<Traits>::value)
+          Ord_init_impl::push_completed(this, &destroy_of);
+
         status = Init_done;
+
+        #endif
       }
 
-    Ord_init() { init(); }
+    Ord_init()
+      {
+        if (is_done())
+          // Initialized early.
+          //
+          Ord_init_impl::keep_for_exit(this);
+        else if (!Ord_init_impl::Is_lazy<Traits>::value)
+          init();
+      }
+
+    #if __cplusplus >= 201100
 
-    T & operator () () { return(* reinterpret_cast<T *>(raw)); }
+    // Register this object, with the objects it depends on, for
+    // initialization by ord_init_parallel().
+    //
+    explicit Ord_init(const Ord_init_impl::Deps &d)
+      {
+        if (atomic_status() != Pre_init)
+          {
+            // Initialized early, without its dependencies.
+            //
+            for (const Ord_init_impl::Dep &dep : d.deps)
+              if (!dep.done(dep.obj))
+                {
+                  Traits t;
+
+                  Ord_init_impl::unordered_init(
+                    t, reinterpret_cast<uintptr_t>(this), 0);
+
+                  break;
+                }
+
+            Ord_init_impl::keep_for_exit(this);
+          }
+        else
+          {
+            Ord_init_impl::Registered r;
+
+            r.self = ord_init_dep(*this);
+            r.cycle = &cycle_of;
+            r.deps = d.deps;
+
+            Ord_init_impl::add_registered(r);
+          }
+      }
+
+    #endif
+
+    T & operator () ()
+      {
+        if (Ord_init_impl::Is_lazy<Traits>::value)
+          init();
+
+        return(* reinterpret_cast<T *>(raw));
+      }
 
     operator T & () { return((*this)()); }
 
     ~Ord_init()
       {
-        if (status == Init_done)
-          reinterpret_cast<T *>(raw)->~T();
+        if (!Ord_init_impl::Is_fast_exit<Traits>::value and is_done() and
+            Ord_init_impl::unlink_completed(this))
+          destroy();
       }
 
+  private:
+
+    void destroy()
+      {
+        reinterpret_cast<T *>(raw)->~T();
+
+        #if __cplusplus >= 201100
+
+        atomic_status() = Destroyed;
+
+        #else
+
+        status = Destroyed;
+
+        #endif
+      }
+
+    // Called at exit.
+    //
+    static void destroy_of(void *p) { static_cast<Ord_init *>(p)->destroy(); }
+
+    bool is_done() const
+      {
+        #if __cplusplus >= 201100
+
+        return(
+          Simple_atomic::Ref<Status>(const_cast<Status &>(status)) ==
+            Init_done);
+
+        #else
+
+        return(status == Init_done);
+
+        #endif
+      }
+
+    static void init_of(void *p) { static_cast<Ord_init *>(p)->init(); }
+
+    static bool done_of(void *p)
+      { return(static_cast<Ord_init *>(p)->is_done()); }
+
+    static void cycle_of(void *p)
+      { Traits().cycle(reinterpret_cast<uintptr_t>(p)); }
+
+    template <class T_, class Traits_>
+    friend Ord_init_impl::Dep ord_init_dep(Ord_init<T_, Traits_> &);
+
   // No copying except through T reference.
   #if __cplusplus < 201100
 
@@ -205,4 +1093,262 @@ class Ord_init
 
   }; // end Ord_init
 
+template <class T, class Traits>
+inline Ord_init_impl::Dep ord_init_dep(Ord_init<T, Traits> &oi)
+  {
+    Ord_init_impl::Dep d;
+
+    d.obj = &oi;
+    d.init = &Ord_init<T, Traits>::init_of;
+    d.done = &Ord_init<T, Traits>::done_of;
+
+    return(d);
+  }
+
+#if __cplusplus >= 201100
+
+// Returns the list of Ord_init objects given as arguments, to pass to the
+// constructor of an Ord_init object that depends on them.
+//
+template <class ... Ord_inits>
+inline Ord_init_impl::Deps ord_init_after(Ord_inits & ... ois)
+  {
+    Ord_init_impl::Deps d;
+
+    d.deps = { ord_init_dep(ois)... };
+
+    return(d);
+  }
+
+inline void ord_init_parallel(unsigned num_threads)
+  {
+    using Ord_init_impl::Registered;
+
+    // Registered objects not yet initialized.
+    //
+    std::vector<const Registered *> nodes;
+
+    std::unordered_map<const void *, std::size_t> index;
+
+    {
+      std::lock_guard<std::mutex> lock(Ord_init_impl::registry_mutex());
+
+      for (const auto &r : Ord_init_impl::registry())
+        if (!r.second.self.done(r.second.self.obj))
+          {
+            index[r.first] = nodes.size();
+            nodes.push_back(&r.second);
+          }
+    }
+
+    // Number of dependencies not yet initialized, and objects depending on,
+    // each object.
+    //
+    std::vector<unsigned> pending(nodes.size(), 0);
+
+    std::vector<std::vector<std::size_t> > dependents(nodes.size());
+
+    for (std::size_t i = 0; i < nodes.size(); ++i)
+      for (const Ord_init_impl::Dep &dep : nodes[i]->deps)
+        {
+          auto d = index.find(dep.obj);
+
+          if (d != index.end())
+            {
+              ++pending[i];
+              dependents[d->second].push_back(i);
+            }
+        }
+
+    std::vector<std::size_t> ready;
+
+    for (std::size_t i = 0; i < nodes.size(); ++i)
+      if (pending[i] == 0)
+        ready.push_back(i);
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    unsigned running = 0;
+    std::exception_ptr error;
+
+    auto work = [&]()
+      {
+        std::unique_lock<std::mutex> lock(mtx);
+
+        for ( ; ; )
+          {
+            while (ready.empty() and running and !error)
+              cv.wait(lock);
+
+            // Stop if all objects that can be initialized are, or after
+            // an exception.
+            //
+            if (ready.empty() or error)
+              break;
+
+            std::size_t i = ready.back();
+            ready.pop_back();
+            ++running;
+
+            lock.unlock();
+
+            std::exception_ptr e;
+
+            try
+              {
+                nodes[i]->self.init(nodes[i]->self.obj);
+              }
+            catch (...)
+              {
+                e = std::current_exception();
+              }
+
+            lock.lock();
+
+            --running;
+
+            if (e)
+              {
+                if (!error)
+                  error = e;
+              }
+            else
+              for (std::size_t d : dependents[i])
+                if (--pending[d] == 0)
+                  ready.push_back(d);
+
+            cv.notify_all();
+          }
+
+        cv.notify_all();
+      };
+
+    std::vector<std::thread> threads;
+
+    for (unsigned t = 1; t < num_threads; ++t)
+      threads.push_back(std::thread(work));
+
+    work();
+
+    for (std::thread &t : threads)
+      t.join();
+
+    if (error)
+      std::rethrow_exception(error);
+
+    for (std::size_t i = 0; i < nodes.size(); ++i)
+      if (pending[i])
+        {
+          // Cycle, or depends on a cycle.  Report an object on the cycle,
+          // found by following uninitialized dependencies until an object
+          // repeats.
+          //
+          std::vector<bool> seen(nodes.size(), false);
+
+          std::size_t j = i;
+
+          while (!seen[j])
+            {
+              seen[j] = true;
+
+              for (const Ord_init_impl::Dep &dep : nodes[j]->deps)
+                {
+                  auto d = index.find(dep.obj);
+
+                  if ((d != index.end()) and pending[d->second])
+                    {
+                      j = d->second;
+                      break;
+                    }
+                }
+            }
+
+          nodes[j]->cycle(nodes[j]->self.obj);
+
+          return;
+        }
+  }
+
+// Write the profile of the initialization of objects whose Traits enable
+// profiling, as Chrome trace events (JSON) to "trace", and as a Graphviz
+// (DOT) graph to "dot".  The times in the trace are in microseconds.  In
+// the graph, each object is labeled with its inclusive and exclusive
+// initialization times in milliseconds, and there is an edge from each
+// object to each object it depends on.
+//
+inline void ord_init_profile_dump(std::ostream &trace, std::ostream &dot)
+  {
+    using namespace Ord_init_impl;
+
+    std::lock_guard<std::mutex> lock(profile().mtx);
+
+    const std::vector<Profile_record> &recs = profile().records;
+
+    Clock::time_point origin;
+
+    if (!recs.empty())
+      origin = recs.front().start;
+
+    for (const Profile_record &r : recs)
+      if (r.start < origin)
+        origin = r.start;
+
+    // Small integer ids for threads.
+    //
+    std::vector<std::thread::id> threads;
+
+    {
+      Ord_init_default_traits::Ifs sentry(trace);
+
+      std::streamsize prec = trace.precision();
+
+      trace << std::dec << std::fixed << std::setprecision(3)
+            << "{\"traceEvents\":[";
+
+      for (std::size_t i = 0; i < recs.size(); ++i)
+        {
+          const Profile_record &r = recs[i];
+
+          std::size_t tid = 0;
+
+          while ((tid < threads.size()) and (threads[tid] != r.thread))
+            ++tid;
+
+          if (tid == threads.size())
+            threads.push_back(r.thread);
+
+          long long ts_ns =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+              r.start - origin).count();
+
+          trace
+            << (i ? ",\n" : "\n")
+            << "{\"name\":\"" << profile_name(r) << "\",\"cat\":\"ord_init\""
+            << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid
+            << ",\"ts\":" << (ts_ns / 1000.0)
+            << ",\"dur\":" << (r.inclusive_ns / 1000.0)
+            << ",\"args\":{\"exclusive_us\":" << (r.exclusive_ns / 1000.0)
+            << ",\"address\":\"" << r.obj << "\"}}";
+        }
+
+      trace << "\n]}\n";
+
+      trace.precision(prec);
+    }
+
+    dot << "digraph ord_init {\n";
+
+    for (const Profile_record &r : recs)
+      dot << "  \"" << r.obj << "\" [label=\"" << profile_name(r) << "\\n"
+          << (r.inclusive_ns / 1000000.0) << " ms / "
+          << (r.exclusive_ns / 1000000.0) << " ms\"];\n";
+
+    for (const std::pair<const void *, const void *> &e : profile().edges)
+      dot << "  \"" << e.first << "\" -> \"" << e.second << "\";\n";
+
+    dot << "}\n";
+  }
+
+#endif
+
 #endif // Include once.
@@ -0,0 +1,344 @@
+// Test of parallel initialization, and thread-safe initialization, of
+// Ord_init objects (C++11 or later).
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+#include "ord_init.h"
+
+const unsigned Num_objs = 9;
+
+// Objects 0 - 3 are independent.  4 depends on 0 and 1.  5 depends on 4
+// and 2.  6 and 7 depend on each other (a cycle), and 8 depends on 6.
+//
+const int Deps[Num_objs][2] =
+  {
+    { -1, -1 }, { -1, -1 }, { -1, -1 }, { -1, -1 },
+    { 0, 1 }, { 4, 2 },
+    { 7, -1 }, { 6, -1 }, { 6, -1 }
+  };
+
+std::atomic<bool> constructed[Num_objs];
+
+// Written by the threads initializing objects.
+//
+std::atomic<bool> failed;
+
+// Number of Obj constructors running, and the maximum number running at
+// the same time.
+//
+std::atomic<unsigned> running, max_running;
+
+template <unsigned N>
+struct Obj
+  {
+    Obj()
+      {
+        for (unsigned d = 0; d < 2; ++d)
+          if ((Deps[N][d] >= 0) and !constructed[Deps[N][d]])
+            {
+              std::cout << "FAILED: " << N << " constructed before "
+                        << Deps[N][d] << '\n';
+
+              failed = true;
+            }
+
+        unsigned r = ++running;
+        unsigned m = max_running;
+
+        while ((r > m) and !max_running.compare_exchange_weak(m, r))
+          ;
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        --running;
+
+        constructed[N] = true;
+      }
+  };
+
+// Counts its constructions.
+//
+struct Shared
+  {
+    static std::atomic<unsigned> count;
+
+    int value;
+
+    Shared()
+      {
+        ++count;
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+        value = 42;
+      }
+  };
+
+std::atomic<unsigned> Shared::count;
+
+// Registered, so it is not initialized by its constructor.
+//
+Ord_init<Shared> shared(ord_init_after());
+
+// Initialization of an object (early) before its constructor is called.
+
+bool unordered_reported;
+
+struct Report_traits : public Ord_init_default_traits
+  {
+    static void unordered_init(uintptr_t) { unordered_reported = true; }
+  };
+
+struct Early_dep { };
+
+struct Early { };
+
+extern Ord_init<Early, Report_traits> early;
+extern Ord_init<Early_dep> early_dep;
+
+struct Uses_early
+  {
+    Uses_early() { early.init(); }
+  };
+
+// Constructed before early and early_dep.
+//
+Uses_early uses_early;
+
+Ord_init<Early, Report_traits> early(ord_init_after(early_dep));
+Ord_init<Early_dep> early_dep(ord_init_after());
+
+// Destruction of objects, and of Ord_init objects that are not static.
+
+struct Counted
+  {
+    static std::atomic<int> constructions, destructions;
+
+    int v;
+
+    Counted() : v(1) { ++constructions; }
+
+    ~Counted() { v = -1; ++destructions; }
+  };
+
+std::atomic<int> Counted::constructions, Counted::destructions;
+
+struct Lazy_traits : public Ord_init_default_traits
+  {
+    static const bool Lazy = true;
+  };
+
+struct Lazy_fast_exit_traits : public Lazy_traits
+  {
+    static const bool Fast_exit = true;
+  };
+
+struct Reg_obj : public Counted { };
+
+struct Lazy_obj : public Counted { };
+
+struct Fast_exit_obj : public Counted { };
+
+Ord_init<Reg_obj> reg(ord_init_after());
+Ord_init<Lazy_obj, Lazy_traits> lz;
+Ord_init<Fast_exit_obj, Lazy_fast_exit_traits> fast_exit;
+
+// Constructed after the Ord_init objects above, but before their objects
+// are initialized (in main()), so destroyed after their objects.
+//
+struct Exit_check
+  {
+    ~Exit_check()
+      {
+        // The Fast_exit object should not be destroyed.  Using the lazy
+        // object after it is destroyed should not construct it again.
+        //
+        lz.init();
+
+        if ((Counted::destructions != 3) or (Counted::constructions != 4))
+          std::cout << "FAILED: wrong objects destroyed at exit\n";
+      }
+  };
+
+Exit_check exit_check;
+
+// Profiling of a profiled object, nested within an object that is not
+// profiled, nested within a profiled object.
+
+struct Profile_traits : public Ord_init_default_traits
+  {
+    static const bool Enable_profile = true;
+  };
+
+const long long Leaf_ns = 50000000;
+
+struct Prof_leaf
+  {
+    Prof_leaf()
+      { std::this_thread::sleep_for(std::chrono::nanoseconds(Leaf_ns)); }
+  };
+
+extern Ord_init<Prof_leaf, Profile_traits> prof_leaf;
+
+struct Unprof_mid
+  {
+    Unprof_mid() { prof_leaf.init(); }
+  };
+
+extern Ord_init<Unprof_mid> unprof_mid;
+
+struct Prof_top
+  {
+    Prof_top() { unprof_mid.init(); }
+  };
+
+Ord_init<Prof_top, Profile_traits> prof_top;
+Ord_init<Unprof_mid> unprof_mid;
+Ord_init<Prof_leaf, Profile_traits> prof_leaf;
+
+extern Ord_init<Obj<6> > o6;
+extern Ord_init<Obj<7> > o7;
+
+Ord_init<Obj<0> > o0(ord_init_after());
+Ord_init<Obj<1> > o1(ord_init_after());
+Ord_init<Obj<2> > o2(ord_init_after());
+Ord_init<Obj<3> > o3(ord_init_after());
+Ord_init<Obj<4> > o4(ord_init_after(o0, o1));
+Ord_init<Obj<5> > o5(ord_init_after(o4, o2));
+Ord_init<Obj<6> > o6(ord_init_after(o7));
+Ord_init<Obj<7> > o7(ord_init_after(o6));
+Ord_init<Obj<8> > o8(ord_init_after(o6));
+
+int main()
+  {
+    // Concurrent first use of an object.
+    //
+    {
+      const unsigned Num_threads = 8;
+
+      std::atomic<unsigned> num_ok(0);
+
+      auto use = [&]()
+        {
+          shared.init();
+
+          if (shared().value == 42)
+            ++num_ok;
+        };
+
+      std::thread t[Num_threads];
+
+      for (unsigned i = 0; i < Num_threads; ++i)
+        t[i] = std::thread(use);
+
+      for (unsigned i = 0; i < Num_threads; ++i)
+        t[i].join();
+
+      if ((Shared::count != 1) or (num_ok != Num_threads))
+        {
+          std::cout << "FAILED: concurrent initialization\n";
+
+          failed = true;
+        }
+    }
+
+    bool cycle = false;
+
+    try
+      {
+        ord_init_parallel(4);
+      }
+    catch (const Ord_init_default_traits::Ord_init_cycle_exception &)
+      {
+        cycle = true;
+      }
+
+    if (!cycle)
+      {
+        std::cout << "FAILED: cycle not detected\n";
+
+        failed = true;
+      }
+
+    for (unsigned i = 0; i < Num_objs; ++i)
+      if (constructed[i] != (i < 6))
+        {
+          std::cout << "FAILED: object " << i << " wrong state\n";
+
+          failed = true;
+        }
+
+    // Four threads, so objects 0 - 3 should be initialized concurrently.
+    // (Their constructors sleep, so they overlap even with one CPU.)
+    //
+    if (max_running < 2)
+      {
+        std::cout << "FAILED: initialization not concurrent\n";
+
+        failed = true;
+      }
+
+    // The time to initialize prof_leaf should be subtracted from the
+    // exclusive time of prof_top, and there should be an edge between them.
+    //
+    {
+      using namespace Ord_init_impl;
+
+      const Profile_record *top = nullptr;
+
+      for (const Profile_record &r : profile().records)
+        if (r.obj == &prof_top)
+          top = &r;
+
+      if (!top or (top->inclusive_ns < Leaf_ns) or
+          (top->exclusive_ns >= Leaf_ns / 2) or
+          !profile().edges.count(
+             std::make_pair<const void *, const void *>(&prof_top, &prof_leaf)))
+        {
+          std::cout << "FAILED: profile through object not profiled\n";
+
+          failed = true;
+        }
+    }
+
+    if (!unordered_reported)
+      {
+        std::cout << "FAILED: early initialization not reported\n";
+
+        failed = true;
+      }
+
+    {
+      Ord_init<Counted> local;
+
+      lz();
+
+      try
+        {
+          ord_init_parallel(2);
+        }
+      catch (const Ord_init_default_traits::Ord_init_cycle_exception &)
+        {
+        }
+    }
+
+    // Destroying local should not destroy static objects initialized after
+    // it.
+    //
+    if ((reg().v != 1) or (lz().v != 1) or (Counted::constructions != 3))
+      {
+        std::cout << "FAILED: static destroyed by local\n";
+
+        failed = true;
+      }
+
+    fast_exit();
+
+    if (!failed)
+      std::cout << "SUCCESS\n";
+
+    return(0);
+  }
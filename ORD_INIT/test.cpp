@@ -22,9 +22,25 @@ class Dep
 template <char C>
 struct Y : private Dep<C>, public X<C> { };
 
+#ifdef PROFILE
+
+// Profiling needs C++11 or later.
+//
+struct Profile_traits : public Ord_init_default_traits
+  {
+    static const bool Enable_profile = true;
+  };
+
+template <char C>
+struct Z : public Ord_init< Y<C>, Profile_traits > { };
+
+#else
+
 template <char C>
 struct Z : public Ord_init< Y<C> > { };
 
+#endif
+
 extern Z<'a'> a;
 extern Z<'b'> b;
 extern Z<'c'> c;
@@ -33,6 +49,24 @@ extern Z<'e'> e;
 extern Z<'f'> f;
 extern Z<'g'> g;
 
+// Used by the destructor of a static object that is not an Ord_init object.
+//
+struct Log
+  {
+    bool alive;
+
+    Log() : alive(true) { std::cout << "construct Log" << std::endl; }
+
+    ~Log()
+      {
+        alive = false;
+
+        std::cout << "~Log()" << std::endl;
+      }
+  };
+
+extern Ord_init<Log> lg;
+
 #if CU == 1
 
 // I don't understand why the destructor for this is not called in
@@ -48,6 +82,8 @@ Z<'a'> a;
 template <>
 void Dep<'a'>::cons() { e.init(); c.init(); }
 
+Ord_init<Log> lg;
+
 #elif CU == 2
 
 Z<'b'> b;
@@ -70,6 +106,19 @@ Z<'e'> e;
 template <>
 void Dep<'e'>::cons() { d.init(); }
 
+// Log must be destroyed after server, even though Ord_init objects are
+// initialized after server is constructed.
+//
+struct Server
+  {
+    Server() { lg.init(); }
+
+    ~Server()
+      { std::cout << "~Server: log alive=" << lg().alive << std::endl; }
+  };
+
+Server server;
+
 #elif CU == 3
 
 Z<'f'> f;
@@ -91,6 +140,45 @@ Z<'g'> g;
 template <>
 void Dep<'g'>::cons() { f.init(); }
 
-int main() { return(0); }
+struct Lazy_traits : public Ord_init_default_traits
+  {
+    static const bool Lazy = true;
+  };
+
+// Initialized after server is constructed (in either link order).
+//
+Ord_init<X<'o'> > other;
+
+// Not constructed until used in main().
+//
+Ord_init<X<'l'>, Lazy_traits> l;
+
+// Never used, so never constructed.
+//
+Ord_init<X<'n'>, Lazy_traits> n;
+
+struct Fast_exit_traits : public Ord_init_default_traits
+  {
+    static const bool Fast_exit = true;
+  };
+
+// Constructed, but never destroyed.
+//
+Ord_init<X<'p'>, Fast_exit_traits> p;
+
+int main()
+  {
+    std::cout << "main" << std::endl;
+
+    #ifdef PROFILE
+
+    ord_init_profile_dump(std::cout, std::cout);
+
+    #endif
+
+    l();
+
+    return(0);
+  }
 
 #endif
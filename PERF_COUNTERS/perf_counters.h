@@ -0,0 +1,351 @@
+/*
+Copyright (c) 2026 Walter William Karas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*
+Hardware performance counters for benchmarks (Linux only), using the
+perf_event_open system call.
+
+Counts are for user mode only, so they work with the default
+perf_event_paranoid setting of 2.  Each event is opened separately.  An
+event that can't be opened (not supported by the CPU, no PMU in a virtual
+machine, not permitted) is marked as not valid, and printed as "n/a".  If
+the kernel multiplexes events, the counts are scaled by the time each
+event was actually counting.
+
+There is no generic event for transfers of modified cache lines between
+cores (HITM).  The raw event for it (model specific) can be given in hex in
+the environment variable PERF_COUNTERS_HITM, for example 0x04d2 for
+MEM_LOAD_L3_HIT_RETIRED.XSNP_HITM on Intel Skylake.  Otherwise, the Hitm
+count is not valid.
+*/
+
+#ifndef PERF_COUNTERS_20261018
+#define PERF_COUNTERS_20261018
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <ostream>
+
+namespace Perf_counters
+{
+
+enum Event
+  {
+    Cycles,
+    Instructions,
+    L1i_misses,
+    L1d_misses,
+    Llc_misses,
+    Branch_misses,
+    Hitm,
+    Num_events
+  };
+
+inline const char * name(Event e)
+  {
+    static const char * const Name[Num_events] =
+      {
+        "cycles", "instr", "L1i-miss", "L1d-miss", "LLC-miss", "br-miss",
+        "hitm"
+      };
+
+    return(Name[e]);
+  }
+
+// Counts for all the events.  An event's count is only meaningful if it is
+// valid.
+//
+struct Values
+  {
+    bool valid[Num_events];
+
+    double count[Num_events];
+
+    Values()
+      {
+        for (unsigned e = 0; e < Num_events; ++e)
+          {
+            valid[e] = false;
+            count[e] = 0;
+          }
+      }
+
+    // Divide all counts by n (to get counts per operation, for example).
+    //
+    Values per(double n) const
+      {
+        Values v = *this;
+
+        for (unsigned e = 0; e < Num_events; ++e)
+          v.count[e] /= n;
+
+        return(v);
+      }
+  };
+
+// Print a line with the name of each event, each in a field "width" wide.
+//
+inline void print_heading(std::ostream &os, int width = 10)
+  {
+    for (unsigned e = 0; e < Num_events; ++e)
+      os << std::setw(width) << name(Event(e));
+  }
+
+// Print each count in a field "width" wide, with "prec" digits after the
+// decimal point, or "n/a" if it is not valid.
+//
+inline void print(
+  std::ostream &os, const Values &v, int width = 10, int prec = 2)
+  {
+    std::ios_base::fmtflags f = os.flags();
+    std::streamsize p = os.precision();
+
+    os << std::fixed << std::setprecision(prec);
+
+    for (unsigned e = 0; e < Num_events; ++e)
+      if (v.valid[e])
+        os << std::setw(width) << v.count[e];
+      else
+        os << std::setw(width) << "n/a";
+
+    os.flags(f);
+    os.precision(p);
+  }
+
+// A set of open counters, for the calling thread, and (if "inherit" is
+// true) for threads it creates while the counters are enabled.  Counts of
+// created threads are only included after the threads exit.  Resetting an
+// inherited counter does not clear the counts (and times) of threads that
+// have exited, so read() returns the counts since start() by subtracting
+// the raw values read at start().
+//
+class Counters
+  {
+  public:
+
+    explicit Counters(bool inherit = true)
+      {
+        for (unsigned e = 0; e < Num_events; ++e)
+          {
+            fd[e] = open(Event(e), inherit);
+
+            base[e][0] = base[e][1] = base[e][2] = 0;
+          }
+      }
+
+    Counters(const Counters &) = delete;
+    Counters & operator = (const Counters &) = delete;
+
+    ~Counters()
+      {
+        for (unsigned e = 0; e < Num_events; ++e)
+          if (fd[e] >= 0)
+            close(fd[e]);
+      }
+
+    // Reset counts to zero, and start counting.
+    //
+    void start()
+      {
+        for (unsigned e = 0; e < Num_events; ++e)
+          if (fd[e] >= 0)
+            {
+              ioctl(fd[e], PERF_EVENT_IOC_RESET, 0);
+
+              if (!read_raw(fd[e], base[e]))
+                base[e][0] = base[e][1] = base[e][2] = 0;
+
+              ioctl(fd[e], PERF_EVENT_IOC_ENABLE, 0);
+            }
+      }
+
+    void stop()
+      {
+        for (unsigned e = 0; e < Num_events; ++e)
+          if (fd[e] >= 0)
+            ioctl(fd[e], PERF_EVENT_IOC_DISABLE, 0);
+      }
+
+    Values read() const
+      {
+        Values v;
+
+        for (unsigned e = 0; e < Num_events; ++e)
+          if (fd[e] >= 0)
+            {
+              std::uint64_t buf[3];
+
+              if (!read_raw(fd[e], buf))
+                continue;
+
+              for (unsigned i = 0; i < 3; ++i)
+                buf[i] -= base[e][i];
+
+              v.valid[e] = true;
+
+              if (buf[2] == 0)
+                v.count[e] = 0;
+              else
+                v.count[e] = double(buf[0]) * double(buf[1]) / double(buf[2]);
+            }
+
+        return(v);
+      }
+
+    // True if any event could be opened.
+    //
+    bool any() const
+      {
+        for (unsigned e = 0; e < Num_events; ++e)
+          if (fd[e] >= 0)
+            return(true);
+
+        return(false);
+      }
+
+  private:
+
+    int fd[Num_events];
+
+    // Raw values read by start().
+    //
+    std::uint64_t base[Num_events][3];
+
+    // Read count, time enabled, and time running.  Returns false on
+    // failure.
+    //
+    static bool read_raw(int fd_, std::uint64_t (&buf)[3])
+      { return(::read(fd_, buf, sizeof(buf)) == sizeof(buf)); }
+
+    // Config for read misses of a cache.
+    //
+    static std::uint64_t cache_config(unsigned cache)
+      {
+        return(
+          cache bitor (PERF_COUNT_HW_CACHE_OP_READ << 8) bitor
+          (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+      }
+
+    // Returns -1 on failure.
+    //
+    static int open(Event e, bool inherit)
+      {
+        perf_event_attr attr;
+
+        std::memset(&attr, 0, sizeof(attr));
+
+        attr.size = sizeof(attr);
+        attr.disabled = 1;
+        attr.inherit = inherit ? 1 : 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format =
+          PERF_FORMAT_TOTAL_TIME_ENABLED bitor PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        switch (e)
+          {
+          case Cycles:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+
+          case Instructions:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+
+          case L1i_misses:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = cache_config(PERF_COUNT_HW_CACHE_L1I);
+            break;
+
+          case L1d_misses:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = cache_config(PERF_COUNT_HW_CACHE_L1D);
+            break;
+
+          case Llc_misses:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CACHE_MISSES;
+            break;
+
+          case Branch_misses:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+
+          case Hitm:
+            {
+              const char *raw = std::getenv("PERF_COUNTERS_HITM");
+
+              if (!raw or !*raw)
+                return(-1);
+
+              attr.type = PERF_TYPE_RAW;
+              attr.config = std::strtoull(raw, nullptr, 16);
+            }
+            break;
+
+          default:
+            return(-1);
+          }
+
+        return(int(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0)));
+      }
+  };
+
+// Starts the counters when constructed, stops them when destroyed, and
+// (if given) stores the counts in "result".
+//
+class Scope
+  {
+  public:
+
+    explicit Scope(Counters &c_, Values *result_ = nullptr)
+      : c(c_), result(result_)
+      { c.start(); }
+
+    Scope(const Scope &) = delete;
+    Scope & operator = (const Scope &) = delete;
+
+    ~Scope()
+      {
+        c.stop();
+
+        if (result)
+          *result = c.read();
+      }
+
+  private:
+
+    Counters &c;
+
+    Values *result;
+  };
+
+} // end namespace Perf_counters
+
+#endif // Include once.
@@ -0,0 +1,123 @@
+/*
+Copyright (c) 2026 Walter William Karas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Unit testing for perf_counters.h.  If hardware counters are not
+// available, all counts should be printed as "n/a".
+
+#include "perf_counters.h"
+#include "perf_counters.h" // test re-inclusion guard
+
+#include <iostream>
+#include <thread>
+
+using namespace Perf_counters;
+
+const unsigned Num_loops = 10 * 1000 * 1000;
+
+volatile unsigned sink;
+
+void loop()
+  {
+    for (unsigned i = 0; i < Num_loops; ++i)
+      sink = i;
+  }
+
+bool failed;
+
+void check(const Values &v, unsigned num_threads)
+  {
+    print_heading(std::cout);
+    std::cout << '\n';
+    print(std::cout, v.per(Num_loops));
+    std::cout << '\n';
+
+    // Each loop iteration is at least a store and a branch.
+    //
+    if (v.valid[Instructions] and
+        (v.count[Instructions] < double(num_threads * 2 * Num_loops)))
+      {
+        std::cout << "FAILED: too few instructions\n";
+
+        failed = true;
+      }
+  }
+
+int main()
+  {
+    Counters c;
+
+    std::cout << "counters " << (c.any() ? "" : "not ") << "available\n";
+
+    Values v;
+
+    {
+      Scope s(c, &v);
+
+      loop();
+    }
+
+    check(v, 1);
+
+    // Counts for a created thread should be included.
+    //
+    {
+      Scope s(c, &v);
+
+      std::thread t(loop);
+
+      loop();
+
+      t.join();
+    }
+
+    check(v, 2);
+
+    Values v1_again;
+
+    // Counts of the exited thread should not be included again.
+    //
+    {
+      Scope s(c, &v1_again);
+
+      loop();
+    }
+
+    check(v1_again, 1);
+
+    if (v1_again.valid[Instructions] and
+        (v1_again.count[Instructions] > (1.5 * v.count[Instructions] / 2)))
+      {
+        std::cout << "FAILED: counts of earlier scope included\n";
+
+        failed = true;
+      }
+
+    for (unsigned e = 0; e < Num_events; ++e)
+      if (v.valid[e] and (v.count[e] < 0))
+        {
+          std::cout << "FAILED: negative count\n";
+
+          failed = true;
+        }
+
+    if (!failed)
+      std::cout << "SUCCESS\n";
+
+    return(0);
+  }
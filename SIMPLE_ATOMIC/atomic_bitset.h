@@ -0,0 +1,302 @@
+/*
+Copyright (c) 2026 Walter William Karas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*
+Fixed-size bitset that multiple threads can modify concurrently, and an
+allocator of small integer ids (slots) built on it.
+
+As with the rest of Simple_atomic, atomic accesses use relaxed ordering.
+Bitset provides no memory fences, Id_allocator provides an acquire fence
+after allocating and a release fence before freeing, like a spin lock.
+*/
+
+#ifndef ATOMIC_BITSET_20261018
+#define ATOMIC_BITSET_20261018
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <thread>
+
+#include "simple_atomic.h"
+
+namespace Simple_atomic
+{
+
+namespace Bitset_impl
+{
+
+using Word = std::uintptr_t;
+
+const std::size_t Word_bits = std::numeric_limits<Word>::digits;
+
+// Index of lowest one bit in w, which must not be zero.
+//
+inline unsigned lowest_one(Word w)
+  {
+    #if defined(__GNUC__)
+
+    return(unsigned(__builtin_ctzll(w)));
+
+    #else
+
+    unsigned i = 0;
+
+    for ( ; !(w & 1); w >>= 1)
+      ++i;
+
+    return(i);
+
+    #endif
+  }
+
+inline unsigned count_ones(Word w)
+  {
+    #if defined(__GNUC__)
+
+    return(unsigned(__builtin_popcountll(w)));
+
+    #else
+
+    unsigned n = 0;
+
+    for ( ; w; w &= w - 1)
+      ++n;
+
+    return(n);
+
+    #endif
+  }
+
+} // end namespace Bitset_impl
+
+template <std::size_t Num_bits>
+class Bitset
+  {
+  public:
+
+    using Word = Bitset_impl::Word;
+
+    static const std::size_t Word_bits = Bitset_impl::Word_bits;
+
+    static const std::size_t Num_words =
+      (Num_bits + Word_bits - 1) / Word_bits;
+
+    // Returned by the find functions when there is no such bit.
+    //
+    static const std::size_t npos = Num_bits;
+
+    // All bits initially clear.
+    //
+    Bitset() { }
+
+    Bitset(const Bitset &) = delete;
+    Bitset & operator = (const Bitset &) = delete;
+
+    static constexpr std::size_t size() { return(Num_bits); }
+
+    bool test(std::size_t i) const { return(w[i / Word_bits] & mask(i)); }
+
+    // Set bit.  Returns the previous value of the bit.
+    //
+    bool set(std::size_t i)
+      { return(w[i / Word_bits].fetch_or(mask(i)) & mask(i)); }
+
+    // Clear bit.  Returns the previous value of the bit.
+    //
+    bool reset(std::size_t i)
+      { return(w[i / Word_bits].fetch_and(~mask(i)) & mask(i)); }
+
+    // Word-level access.  Bit i is in word i / Word_bits, at position
+    // i % Word_bits.  The fetch functions return the previous word value.
+
+    Word word(std::size_t widx) const { return(w[widx]); }
+
+    Word fetch_or_word(std::size_t widx, Word m)
+      { return(w[widx].fetch_or(m)); }
+
+    Word fetch_and_word(std::size_t widx, Word m)
+      { return(w[widx].fetch_and(m)); }
+
+    // Mask of the bits in the word with index widx that are in the bitset
+    // (all ones except possibly for the last word).
+    //
+    static constexpr Word valid_mask(std::size_t widx)
+      {
+        return(
+          ((widx + 1) < Num_words) or ((Num_bits % Word_bits) == 0) ?
+            ~Word(0) : ((Word(1) << (Num_bits % Word_bits)) - 1));
+      }
+
+    // Find a clear bit, starting at the word containing bit "start" and
+    // wrapping around.  Returns npos if all bits are set.  The result may be
+    // stale by the time it is returned, if other threads are modifying the
+    // bitset.
+    //
+    std::size_t find_first_clear(std::size_t start = 0) const
+      { return(find_(start, ~Word(0))); }
+
+    // Like find_first_clear(), but finds a set bit.
+    //
+    std::size_t find_first_set(std::size_t start = 0) const
+      { return(find_(start, 0)); }
+
+    // Number of set bits (not a consistent snapshot if the bitset is being
+    // concurrently modified).
+    //
+    std::size_t count() const
+      {
+        std::size_t n = 0;
+
+        for (std::size_t widx = 0; widx < Num_words; ++widx)
+          n += Bitset_impl::count_ones(w[widx] & valid_mask(widx));
+
+        return(n);
+      }
+
+  private:
+
+    Simple_atomic::T<Word> w[Num_words];
+
+    static Word mask(std::size_t i) { return(Word(1) << (i % Word_bits)); }
+
+    std::size_t find_(std::size_t start, Word flip) const
+      {
+        std::size_t widx = start / Word_bits;
+
+        for (std::size_t n = 0; n < Num_words; ++n)
+          {
+            Word x = (w[widx] ^ flip) & valid_mask(widx);
+
+            if (x)
+              return((widx * Word_bits) + Bitset_impl::lowest_one(x));
+
+            if (++widx == Num_words)
+              widx = 0;
+          }
+
+        return(npos);
+      }
+
+  }; // end class Bitset
+
+// Lock-free allocator of ids in the range 0 to Num_ids - 1.
+//
+// Each thread should have its own "hint", the index of the word where it
+// will start looking for a free id.  Giving threads different hints means
+// they mostly modify different words (and, for large bitsets, different
+// cache lines).
+//
+template <std::size_t Num_ids>
+class Id_allocator
+  {
+  private:
+
+    using Bits = Bitset<Num_ids>;
+
+    using Word = typename Bits::Word;
+
+    Bits in_use;
+
+  public:
+
+    // Returned by alloc() when all ids are allocated.
+    //
+    static const std::size_t None = Num_ids;
+
+    static const std::size_t Num_hints = Bits::Num_words;
+
+    Id_allocator() { }
+
+    // A reasonable initial value for a thread's hint.
+    //
+    static std::size_t initial_hint(std::thread::id tid)
+      { return(std::hash<std::thread::id>()(tid) % Num_hints); }
+
+    // Allocate an id, starting the search at word "hint".  On success, hint
+    // is updated to the word where the id was found.  Provides an acquire
+    // memory fence on success.
+    //
+    std::size_t alloc(std::size_t &hint)
+      {
+        std::size_t widx = hint;
+
+        for (std::size_t n = 0; n < Num_hints; ++n)
+          {
+            const Word valid = Bits::valid_mask(widx);
+
+            Word curr = in_use.word(widx);
+
+            while (~curr & valid)
+              {
+                Word bit = Word(1) << Bitset_impl::lowest_one(~curr & valid);
+
+                curr = in_use.fetch_or_word(widx, bit);
+
+                if (!(curr & bit))
+                  {
+                    hint = widx;
+
+                    Simple_atomic::acquire();
+
+                    return((widx * Bits::Word_bits) +
+                           Bitset_impl::lowest_one(bit));
+                  }
+              }
+
+            if (++widx == Num_hints)
+              widx = 0;
+          }
+
+        return(None);
+      }
+
+    // Allocate using a hint private to the calling thread.  (The hint is
+    // shared by all instances of Id_allocator<Num_ids> used by the thread.)
+    //
+    std::size_t alloc()
+      {
+        thread_local std::size_t hint =
+          initial_hint(std::this_thread::get_id());
+
+        return(alloc(hint));
+      }
+
+    // Free an allocated id.  Provides a release memory fence.
+    //
+    void free(std::size_t id)
+      {
+        Simple_atomic::release();
+
+        in_use.reset(id);
+      }
+
+    bool is_allocated(std::size_t id) const { return(in_use.test(id)); }
+
+    // Number of allocated ids (not a consistent snapshot if ids are being
+    // concurrently allocated or freed).
+    //
+    std::size_t num_allocated() const { return(in_use.count()); }
+
+  }; // end class Id_allocator
+
+} // end namespace Simple_atomic
+
+#endif // Include once.
@@ -0,0 +1,160 @@
+/*
+Copyright (c) 2026 Walter William Karas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Unit testing for atomic_bitset.h.
+
+#include "atomic_bitset.h"
+#include "atomic_bitset.h" // test re-inclusion guard
+
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Not a multiple of the word size, to test the partial last word.
+//
+const std::size_t Num_ids = 200;
+
+const unsigned Num_threads = 8;
+
+const unsigned Allocs_per_thread = 100000;
+
+Simple_atomic::Id_allocator<Num_ids> ids;
+
+// owner[id] is the index plus one of the thread that has id allocated, or
+// zero.
+//
+Simple_atomic::T<unsigned> owner[Num_ids];
+
+Simple_atomic::T<bool> failed;
+
+void fail(const char *msg)
+  {
+    std::cout << "FAILED: " << msg << '\n';
+
+    failed = true;
+  }
+
+void test_bitset()
+  {
+    Simple_atomic::Bitset<Num_ids> b;
+
+    if (b.find_first_set() != b.npos)
+      fail("find_first_set() on empty bitset");
+
+    if (b.find_first_clear(150) != 128)
+      fail("find_first_clear() does not start at word");
+
+    if (b.set(70) or !b.set(70) or !b.test(70))
+      fail("set()");
+
+    if (b.find_first_set(100) != 70)
+      fail("find_first_set() does not wrap");
+
+    if (!b.reset(70) or b.reset(70) or b.test(70))
+      fail("reset()");
+
+    for (std::size_t i = 0; i < Num_ids; ++i)
+      b.set(i);
+
+    if (b.count() != Num_ids)
+      fail("count()");
+
+    if (b.find_first_clear() != b.npos)
+      fail("find_first_clear() on full bitset");
+  }
+
+void thread_func(unsigned idx)
+  {
+    std::vector<std::size_t> held;
+
+    // std::rand() is not thread-safe.
+    //
+    std::minstd_rand rand(idx + 1);
+
+    for (unsigned i = 0; i < Allocs_per_thread; ++i)
+      {
+        std::size_t id = ids.alloc();
+
+        if (id != ids.None)
+          {
+            unsigned expected = 0;
+
+            if (!owner[id].compare_exchange(expected, idx + 1))
+              {
+                fail("id allocated to two threads");
+
+                return;
+              }
+
+            held.push_back(id);
+          }
+
+        // Free in a different order than allocated.
+        //
+        if ((held.size() > 20) or ((id == ids.None) and !held.empty()))
+          {
+            std::size_t j = std::size_t(rand()) % held.size();
+
+            owner[held[j]] = 0;
+
+            ids.free(held[j]);
+
+            held[j] = held.back();
+            held.pop_back();
+          }
+      }
+
+    for (std::size_t id : held)
+      {
+        owner[id] = 0;
+
+        ids.free(id);
+      }
+  }
+
+int main()
+  {
+    test_bitset();
+
+    std::vector<std::thread> t;
+
+    for (unsigned i = 0; i < Num_threads; ++i)
+      t.emplace_back(thread_func, i);
+
+    for (unsigned i = 0; i < Num_threads; ++i)
+      t[i].join();
+
+    if (ids.num_allocated() != 0)
+      fail("ids not all freed");
+
+    std::size_t hint = 0;
+
+    for (std::size_t i = 0; i < Num_ids; ++i)
+      if (ids.alloc(hint) == ids.None)
+        fail("alloc() failed with free ids");
+
+    if (ids.alloc(hint) != ids.None)
+      fail("alloc() succeeded with no free ids");
+
+    if (!failed)
+      std::cout << "SUCCESS\n";
+
+    return(0);
+  }
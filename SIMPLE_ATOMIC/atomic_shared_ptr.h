@@ -0,0 +1,359 @@
+/*
+Copyright (c) 2026 Walter William Karas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*
+Shared ownership pointer (Shared_ptr), and a lock-free atomic variable
+holding one (Atomic_shared_ptr).
+
+Atomic_shared_ptr uses a split reference count.  The (one word) atomic
+variable holds, along with the pointer, a "local" count of threads in the
+middle of loading it.  A loading thread first increments the local count,
+which keeps the object alive, then increments the object's ("global")
+count, then decrements the local count.  When the pointer is replaced, the
+local count is transferred to the global count.
+
+Loading still writes the object's count cache line.  For objects that are
+read often and replaced rarely (like configuration), each reading thread
+should use an Atomic_shared_ptr<>::Cache.  Reading through a Cache only
+reads the atomic variable, unless the pointer has been replaced.
+
+The atomic variable is packed into 64 bits, with the pointer in bits 6
+through 47.  This requires 64-bit pointers where the upper 16 bits of user
+space addresses are zero (true for x86-64 and AArch64, except for Linux
+with 5-level page tables when an mmap hint above 47 bits is used).
+
+The upper 16 bits hold a count of stores, which wraps after 65536 stores.
+A load holds a local count between two compare and exchanges.  If, while
+a loading thread is stalled between them, exactly a multiple of 65536
+stores are done, and the last stores back the same pointer, the load
+cannot tell that the pointer was replaced (an ABA problem), and the counts
+of the object are wrong.  So there must be fewer than 65536 stores to an
+Atomic_shared_ptr during any one load.
+
+Requires C++17 (for aligned allocation of control blocks).
+*/
+
+#ifndef ATOMIC_SHARED_PTR_20261018
+#define ATOMIC_SHARED_PTR_20261018
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <thread>
+#include <utility>
+
+#include "simple_atomic.h"
+
+static_assert(
+  __cplusplus >= 201703L,
+  "atomic_shared_ptr.h requires C++17, for aligned new of control blocks");
+
+namespace Simple_atomic
+{
+
+template <typename T_>
+class Atomic_shared_ptr;
+
+namespace Shared_impl
+{
+
+// Low bits of pointer in packed word that are zero due to alignment.
+//
+const unsigned Align_bits = 6;
+
+const std::size_t Block_align = std::size_t(1) << Align_bits;
+
+// Control block and object, allocated together.
+//
+template <typename T_>
+struct alignas(Block_align) Block
+  {
+    Simple_atomic::T<long> count;
+
+    T_ obj;
+
+    template <typename ... Args>
+    Block(Args && ... args) : count(1), obj(std::forward<Args>(args)...) { }
+  };
+
+} // end namespace Shared_impl
+
+template <typename T_>
+class Shared_ptr
+  {
+  public:
+
+    Shared_ptr() : b(nullptr) { }
+
+    Shared_ptr(const Shared_ptr &p) : b(p.b)
+      { if (b) b->count.fetch_add(1); }
+
+    Shared_ptr(Shared_ptr &&p) : b(p.b) { p.b = nullptr; }
+
+    Shared_ptr & operator = (Shared_ptr p)
+      {
+        std::swap(b, p.b);
+
+        return(*this);
+      }
+
+    ~Shared_ptr() { reset(); }
+
+    void reset()
+      {
+        if (b)
+          {
+            Simple_atomic::release();
+
+            if (b->count.fetch_sub(1) == 1)
+              {
+                Simple_atomic::acquire();
+
+                delete b;
+              }
+
+            b = nullptr;
+          }
+      }
+
+    T_ * get() const { return(b ? &b->obj : nullptr); }
+
+    T_ & operator * () const { return(b->obj); }
+
+    T_ * operator -> () const { return(&b->obj); }
+
+    explicit operator bool () const { return(b != nullptr); }
+
+    // Only a hint if other threads are copying or destroying Shared_ptrs
+    // pointing to the same object.
+    //
+    long use_count() const { return(b ? long(b->count) : 0); }
+
+    friend bool operator == (const Shared_ptr &p1, const Shared_ptr &p2)
+      { return(p1.b == p2.b); }
+
+    friend bool operator != (const Shared_ptr &p1, const Shared_ptr &p2)
+      { return(p1.b != p2.b); }
+
+    template <typename U, typename ... Args>
+    friend Shared_ptr<U> make_shared(Args && ... args);
+
+  private:
+
+    using Block = Shared_impl::Block<T_>;
+
+    Block *b;
+
+    // Takes ownership of one count of the block.
+    //
+    explicit Shared_ptr(Block *b_) : b(b_) { }
+
+    friend class Atomic_shared_ptr<T_>;
+
+  }; // end class Shared_ptr
+
+// Construct an object of type T_, and return a Shared_ptr to it.
+//
+template <typename T_, typename ... Args>
+Shared_ptr<T_> make_shared(Args && ... args)
+  {
+    return(
+      Shared_ptr<T_>(
+        new Shared_impl::Block<T_>(std::forward<Args>(args)...)));
+  }
+
+// All member functions are lock-free.  load() and store() provide the
+// same memory ordering as acquire loads and release stores.
+//
+template <typename T_>
+class Atomic_shared_ptr
+  {
+  public:
+
+    Atomic_shared_ptr() : w(0) { }
+
+    explicit Atomic_shared_ptr(Shared_ptr<T_> p) : w(0)
+      { store(std::move(p)); }
+
+    Atomic_shared_ptr(const Atomic_shared_ptr &) = delete;
+    Atomic_shared_ptr & operator = (const Atomic_shared_ptr &) = delete;
+
+    ~Atomic_shared_ptr() { exchange(Shared_ptr<T_>()); }
+
+    Shared_ptr<T_> load() const
+      {
+        Word curr = w;
+
+        for ( ; ; )
+          {
+            if (!block(curr))
+              {
+                Simple_atomic::acquire();
+
+                return(Shared_ptr<T_>());
+              }
+
+            if (local(curr) == Max_local)
+              {
+                // Very unlikely.
+                //
+                std::this_thread::yield();
+
+                curr = w;
+              }
+            else if (w.compare_exchange(curr, curr + 1))
+              break;
+          }
+
+        Block *b = block(curr);
+
+        // Holding a local count, so the object can't be destroyed.
+        //
+        b->count.fetch_add(1);
+
+        // Return the local count.
+        //
+        Word expected = curr + 1;
+
+        for ( ; ; )
+          {
+            if ((expected bitor Local_mask) != (curr bitor Local_mask))
+              {
+                // The pointer was replaced, and the local count transferred
+                // to the global count.  This thread already has a global
+                // count, so the global count can't go to zero.
+                //
+                b->count.fetch_sub(1);
+
+                break;
+              }
+
+            if (w.compare_exchange(expected, expected - 1))
+              break;
+          }
+
+        Simple_atomic::acquire();
+
+        return(Shared_ptr<T_>(b));
+      }
+
+    void store(Shared_ptr<T_> p) { exchange(std::move(p)); }
+
+    Shared_ptr<T_> exchange(Shared_ptr<T_> p)
+      {
+        Block *nb = p.b;
+
+        p.b = nullptr;
+
+        if (std::uintptr_t(nb) bitand ~Ptr_mask)
+          // Address has bits outside of those available in packed word.
+          //
+          std::abort();
+
+        Simple_atomic::release();
+
+        Word curr = w;
+
+        while (!w.compare_exchange(
+                  curr,
+                  (((curr bitor Ptr_mask bitor Local_mask) + 1)) bitor
+                  std::uintptr_t(nb)))
+          ;
+
+        Block *ob = block(curr);
+
+        // The reference held by this atomic variable is passed on to the
+        // returned Shared_ptr.
+        //
+        if (ob and local(curr))
+          ob->count.fetch_add(long(local(curr)));
+
+        Simple_atomic::acquire();
+
+        return(Shared_ptr<T_>(ob));
+      }
+
+    Atomic_shared_ptr & operator = (Shared_ptr<T_> p)
+      {
+        store(std::move(p));
+
+        return(*this);
+      }
+
+    operator Shared_ptr<T_> () const { return(load()); }
+
+    // Per-thread cache of the loaded pointer.
+    //
+    class Cache
+      {
+      public:
+
+        // Returns a (possibly cached) copy of the value of a.  Should always
+        // be called with the same Atomic_shared_ptr.  The returned reference
+        // is only valid until the next call.  There is a memory acquire
+        // fence only if the value has changed since the previous call.
+        //
+        const Shared_ptr<T_> & get(const Atomic_shared_ptr &a)
+          {
+            if (a.block(a.w) != sp.b)
+              sp = a.load();
+
+            return(sp);
+          }
+
+      private:
+
+        Shared_ptr<T_> sp;
+      };
+
+  private:
+
+    using Block = Shared_impl::Block<T_>;
+
+    static_assert(sizeof(void *) == 8, "requires 64-bit pointers");
+
+    using Word = std::uintptr_t;
+
+    static const unsigned Align_bits = Shared_impl::Align_bits;
+
+    // Bits of packed word with local count.
+    //
+    static const Word Local_mask = (Word(1) << Align_bits) - 1;
+
+    static const Word Max_local = Local_mask;
+
+    // Bits of packed word with pointer.  The remaining (high) bits are a
+    // count of stores, so a load can tell if the pointer was replaced even
+    // if the same pointer was stored again (unless the count wraps, see
+    // above).
+    //
+    static const Word Ptr_mask = ((Word(1) << 48) - 1) bitand ~Local_mask;
+
+    mutable Simple_atomic::T<Word> w;
+
+    static Block * block(Word v)
+      { return(reinterpret_cast<Block *>(v bitand Ptr_mask)); }
+
+    static Word local(Word v) { return(v bitand Local_mask); }
+
+  }; // end class Atomic_shared_ptr
+
+} // end namespace Simple_atomic
+
+#endif // Include once.
@@ -0,0 +1,139 @@
+/*
+Copyright (c) 2026 Walter William Karas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Unit testing for atomic_shared_ptr.h.
+
+#include "atomic_shared_ptr.h"
+#include "atomic_shared_ptr.h" // test re-inclusion guard
+
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace Simple_atomic;
+
+// Number of existing Config objects.
+//
+T<long> num_live;
+
+T<bool> failed;
+
+struct Config
+  {
+    // Every field is equal to version, so a reader can check if it sees a
+    // partially initialized or destroyed object.
+    //
+    unsigned version, a, b, c;
+
+    Config(unsigned v) : version(v), a(v), b(v), c(v)
+      { num_live.fetch_add(1); }
+
+    ~Config()
+      {
+        version = a = b = c = ~0U;
+
+        num_live.fetch_sub(1);
+      }
+
+    bool ok() const { return((a == version) and (b == version) and
+                             (c == version)); }
+  };
+
+const unsigned Num_readers = 4;
+
+const unsigned Num_stores = 20000;
+
+Atomic_shared_ptr<Config> config;
+
+T<bool> done;
+
+void reader(bool use_cache)
+  {
+    Atomic_shared_ptr<Config>::Cache cache;
+
+    unsigned last_version = 0;
+
+    while (!done)
+      {
+        Shared_ptr<Config> p;
+
+        const Shared_ptr<Config> &cp = use_cache ? cache.get(config) :
+                                                   (p = config.load());
+
+        if (!cp->ok() or (cp->version < last_version))
+          failed = true;
+
+        last_version = cp->version;
+      }
+  }
+
+void writer()
+  {
+    for (unsigned v = 2; v <= Num_stores; ++v)
+      {
+        // Sometimes store the same object again.
+        //
+        if (v % 7)
+          config.store(make_shared<Config>(v));
+        else
+          config.store(config.load());
+      }
+
+    done = true;
+  }
+
+int main()
+  {
+    config = make_shared<Config>(1);
+
+    std::vector<std::thread> t;
+
+    for (unsigned i = 0; i < Num_readers; ++i)
+      t.emplace_back(reader, bool(i % 2));
+
+    writer();
+
+    for (auto &th : t)
+      th.join();
+
+    {
+      Shared_ptr<Config> p = config.exchange(Shared_ptr<Config>());
+
+      if ((p.use_count() != 1) or config.load())
+        {
+          std::cout << "FAILED: exchange\n";
+
+          failed = true;
+        }
+    }
+
+    if (num_live != 0)
+      {
+        std::cout << "FAILED: " << long(num_live) << " objects not freed\n";
+
+        failed = true;
+      }
+
+    if (failed)
+      std::cout << "FAILED\n";
+    else
+      std::cout << "SUCCESS\n";
+
+    return(0);
+  }
@@ -0,0 +1,167 @@
+/*
+Copyright (c) 2026 Walter William Karas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*
+Reusable, sense-reversing thread barrier, that spins before it waits.
+
+The barrier is centralized (all threads decrement one counter), which is
+the fastest kind for the numbers of threads sharing a last-level cache.
+The sense is the low bit of a phase counter, so threads don't need to keep
+any state of their own between phases.
+
+The time when each phase is released is recorded, so threads can measure
+how long after the release they actually started running (skew).
+*/
+
+#ifndef BARRIER_20261018
+#define BARRIER_20261018
+
+#include <chrono>
+#include <thread>
+
+#include "simple_atomic.h"
+
+namespace Simple_atomic
+{
+
+struct Barrier_default_traits
+  {
+    using Clock = std::chrono::steady_clock;
+
+    // Number of retries that only spin.
+    //
+    static const unsigned Spin_count = 4000;
+
+    // Called before each retry at checking for release.  "tries" is the
+    // number of checks preceeding the call.
+    //
+    static void retry(unsigned tries)
+      {
+        if (tries > Spin_count)
+          std::this_thread::yield();
+        else
+          {
+            #if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+
+            __builtin_ia32_pause();
+
+            #endif
+          }
+      }
+  };
+
+// The "Traits" template parameter is expected to have the following public
+// members:
+//
+// type Clock -- clock meeting the standard TrivialClock requirements, whose
+//   rep type can be an atomic.
+//
+// static void retry(unsigned tries) -- called by each waiting thread
+//   before each retry at checking for release of the barrier.  "tries" is
+//   the number of checks preceeding the call.  Can yield, sleep, or block
+//   in some other way.
+//
+template <class Traits = Barrier_default_traits>
+class Barrier
+  {
+  public:
+
+    using Clock = typename Traits::Clock;
+
+    using Time = typename Clock::time_point;
+
+    explicit Barrier(unsigned num_threads_)
+      : num_threads(num_threads_), count(num_threads_), phase(0), release_t(0)
+      { }
+
+    Barrier(const Barrier &) = delete;
+    Barrier & operator = (const Barrier &) = delete;
+
+    // Returns after num_threads threads have called this function for the
+    // current phase.  Returns true in exactly one of the threads (the last
+    // one to arrive).  Provides release memory fence before arriving, and
+    // an acquire fence after release.  So all writes by any thread before
+    // calling this are visible to all the threads after it returns.
+    //
+    bool arrive_and_wait()
+      {
+        // The phase can't change until this thread arrives.
+        //
+        unsigned p = phase;
+
+        Simple_atomic::release();
+
+        if (count.fetch_sub(1) == 1)
+          {
+            Simple_atomic::acquire();
+
+            count = num_threads;
+
+            release_t = Clock::now().time_since_epoch().count();
+
+            Simple_atomic::make_visible();
+
+            phase = p + 1;
+
+            return(true);
+          }
+
+        unsigned tries = 0;
+
+        while (phase == p)
+          Traits::retry(++tries);
+
+        Simple_atomic::acquire();
+
+        return(false);
+      }
+
+    // Time when the most recent phase was released.  Call after
+    // arrive_and_wait() returns, before the next phase can be released.
+    //
+    Time release_time() const
+      { return(Time(typename Clock::duration(release_t))); }
+
+    // Number of phases released.  (The low bit of this is the sense.)
+    //
+    unsigned phases() const { return(phase); }
+
+    unsigned size() const { return(num_threads); }
+
+  private:
+
+    static const unsigned Cache_line = 64;
+
+    const unsigned num_threads;
+
+    // Number of threads yet to arrive in the current phase.  Arriving
+    // threads write this, waiting threads read "phase", so they are kept
+    // in separate cache lines.
+    //
+    alignas(Cache_line) Simple_atomic::T<unsigned> count;
+
+    alignas(Cache_line) Simple_atomic::T<unsigned> phase;
+
+    Simple_atomic::T<typename Clock::rep> release_t;
+
+  }; // end class Barrier
+
+} // end namespace Simple_atomic
+
+#endif // Include once.
@@ -0,0 +1,122 @@
+/*
+Copyright (c) 2026 Walter William Karas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Unit testing for barrier.h.
+
+#include "barrier.h"
+#include "barrier.h" // test re-inclusion guard
+
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+const unsigned Num_threads = 6;
+
+const unsigned Num_phases = 2000;
+
+using Barrier = Simple_atomic::Barrier<>;
+
+Barrier barrier(Num_threads);
+
+// In each phase, each thread writes its entry in one row, then (after the
+// barrier) checks that all the entries in the row were written.  The rows
+// alternate, so the writes for the next phase do not disturb the checks.
+//
+unsigned slot[2][Num_threads];
+
+unsigned last_count[Num_threads];
+
+Barrier::Clock::duration max_skew[Num_threads];
+
+Simple_atomic::T<bool> failed;
+
+void thread_func(unsigned idx)
+  {
+    for (unsigned p = 1; p <= Num_phases; ++p)
+      {
+        slot[p % 2][idx] = p;
+
+        if (barrier.arrive_and_wait())
+          ++last_count[idx];
+
+        Barrier::Clock::duration skew =
+          Barrier::Clock::now() - barrier.release_time();
+
+        if (skew > max_skew[idx])
+          max_skew[idx] = skew;
+
+        for (unsigned i = 0; i < Num_threads; ++i)
+          if (slot[p % 2][i] != p)
+            failed = true;
+
+        // Keep the next phase from being released before all threads are
+        // done checking.
+        //
+        barrier.arrive_and_wait();
+      }
+  }
+
+int main()
+  {
+    std::vector<std::thread> t;
+
+    for (unsigned i = 1; i < Num_threads; ++i)
+      t.emplace_back(thread_func, i);
+
+    thread_func(0);
+
+    for (auto &th : t)
+      th.join();
+
+    if (failed)
+      std::cout << "FAILED: write before barrier not visible after it\n";
+
+    unsigned ttl = 0;
+
+    for (unsigned i = 0; i < Num_threads; ++i)
+      {
+        ttl += last_count[i];
+
+        std::cout << "thread " << i << ": last to arrive " << last_count[i]
+                  << " times, max skew = "
+                  << std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       max_skew[i]).count()
+                  << " ns\n";
+      }
+
+    if (ttl != Num_phases)
+      {
+        std::cout << "FAILED: number of last arrivals\n";
+
+        failed = true;
+      }
+
+    if (barrier.phases() != (2 * Num_phases))
+      {
+        std::cout << "FAILED: number of phases\n";
+
+        failed = true;
+      }
+
+    if (!failed)
+      std::cout << "SUCCESS\n";
+
+    return(0);
+  }
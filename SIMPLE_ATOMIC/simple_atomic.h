@@ -69,6 +69,23 @@ class T
             expected, desired, std::memory_order_relaxed));
       }
 
+    // Read-modify-write operations.  Each returns the value before the
+    // operation.  (The bitwise ones are only valid for integral types, the
+    // arithmetic ones for integral and pointer types.)
+    //
+    T_ exchange(T_ desired)
+      { return(v.exchange(desired, std::memory_order_relaxed)); }
+
+    template <typename Arg>
+    T_ fetch_add(Arg a) { return(v.fetch_add(a, std::memory_order_relaxed)); }
+
+    template <typename Arg>
+    T_ fetch_sub(Arg a) { return(v.fetch_sub(a, std::memory_order_relaxed)); }
+
+    T_ fetch_or(T_ a) { return(v.fetch_or(a, std::memory_order_relaxed)); }
+
+    T_ fetch_and(T_ a) { return(v.fetch_and(a, std::memory_order_relaxed)); }
+
     std::atomic<T_> & raw() { return(v); }
 
     const std::atomic<T_> & raw() const { return(v); }
@@ -82,6 +99,61 @@ class T
 
   }; // end class T
 
+// Atomic access to a variable not declared atomic.  This is useful for a
+// variable that must be zero initialized, and not later changed by a
+// constructor (because it may be used before the constructor is called).
+// T_ must be trivially copyable, and the variable must be aligned as
+// required for atomic access.  Uses the GCC (or Clang) atomic built-ins.
+//
+template <typename T_>
+class Ref
+  {
+  public:
+
+    explicit Ref(T_ &v_) : v(v_) { }
+
+    Ref & operator = (T_ v_) { store(v_); return(*this); }
+
+    operator T_ () const { return(load()); }
+
+    T_ operator () () const { return(load()); }
+
+    // Same as T::compare_exchange().
+    //
+    bool compare_exchange(T_ &expected, T_ desired)
+      {
+        return(
+          __atomic_compare_exchange(
+            &v, &expected, &desired, true, __ATOMIC_RELAXED,
+            __ATOMIC_RELAXED));
+      }
+
+    T_ exchange(T_ desired)
+      {
+        T_ result;
+
+        __atomic_exchange(&v, &desired, &result, __ATOMIC_RELAXED);
+
+        return(result);
+      }
+
+  private:
+
+    T_ &v;
+
+    T_ load() const
+      {
+        T_ result;
+
+        __atomic_load(&v, &result, __ATOMIC_RELAXED);
+
+        return(result);
+      }
+
+    void store(T_ v_) { __atomic_store(&v, &v_, __ATOMIC_RELAXED); }
+
+  }; // end class Ref
+
 // Memory fences
 
 inline void release() { std::atomic_thread_fence(std::memory_order_release); }
@@ -19,6 +19,8 @@ SOFTWARE.
 
 #include "common.h"
 
+#include "perf_counters.h"
+
 #include <chrono>
 #include <iostream>
 #include <iomanip>
@@ -79,15 +81,25 @@ struct Fill_empty_set_poly
       }
   };
 
-// Return how long it takes to repeatedly execute a particular function.
+unsigned const Reps_of_func{100000 / Num_S};
+
+// Return how long it takes to repeatedly execute a particular function.  The hardware counts (per execution
+// of the function) are put in pc.
 //
-auto time_func(void (*func)())
+auto time_func(void (*func)(), Perf_counters::Values &pc)
   {
-    unsigned const Reps_of_func{100000 / Num_S};
-    auto start{std::chrono::steady_clock::now()};
-    for (unsigned i{0}; i < Reps_of_func; ++i)
-      func();
-    auto stop{std::chrono::steady_clock::now()};
+    static Perf_counters::Counters counters{false};
+
+    std::chrono::steady_clock::time_point start, stop;
+    {
+      Perf_counters::Scope ps{counters, &pc};
+
+      start = std::chrono::steady_clock::now();
+      for (unsigned i{0}; i < Reps_of_func; ++i)
+        func();
+      stop = std::chrono::steady_clock::now();
+    }
+    pc = pc.per(Reps_of_func);
 
     return std::chrono::duration<double>(stop - start);
   }
@@ -96,13 +108,24 @@ auto time_func(void (*func)())
 
 int main()
   {
-    auto gp{time_func(Rep<Num_S, Fill_empty_set>::x)};
+    Perf_counters::Values gp_pc, poly_pc;
+
+    auto gp{time_func(Rep<Num_S, Fill_empty_set>::x, gp_pc)};
 
-    auto poly{time_func(Rep<Num_S, Fill_empty_set_poly>::x)};
+    auto poly{time_func(Rep<Num_S, Fill_empty_set_poly>::x, poly_pc)};
 
     std::cout << "Generic Programming = " << gp << '\n';
     std::cout << "Polymorphism        = " << poly << '\n';
     std::cout << "Poly / GP           = " << (poly.count() / gp.count()) << '\n';
 
+    std::cout << "\nHardware counts per " << Num_S << " fill/empty calls:\n";
+    std::cout << "                     ";
+    Perf_counters::print_heading(std::cout, 12);
+    std::cout << "\nGeneric Programming  ";
+    Perf_counters::print(std::cout, gp_pc, 12, 1);
+    std::cout << "\nPolymorphism         ";
+    Perf_counters::print(std::cout, poly_pc, 12, 1);
+    std::cout << '\n';
+
     return 0;
   }